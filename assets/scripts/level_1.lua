@@ -100,9 +100,21 @@ Level = {
         num_rows = 20,
         num_cols = 25,
         tile_size = 32,
-        scale = 2.0
+        scale = 2.0,
+        -- tiles colliders cannot go through (collision layer 2), named by
+        -- their two digits in the map file, e.g. { [0] = 21, 22 }
+        solid_tiles = {}
     },
 
+    ----------------------------------------------------
+    -- pairs of collision layers that never collide. Box colliders take an
+    -- optional layer (0 - 31, default 0) and mask (bit n = collides with
+    -- layer n, default all). The engine puts projectiles on layer 1 and
+    -- already ignores projectile vs projectile.
+    -- e.g. { [0] = { 2, 3 }, { 2, 2 } }
+    ----------------------------------------------------
+    ignored_collision_layer_pairs = {},
+
     ----------------------------------------------------
     -- table to define entities and their components
     ----------------------------------------------------
@@ -0,0 +1,56 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+// fixtures shared by the benchmarks
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "../src/collision/aabb.h"
+
+inline double MillisecondsSince(const std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline double SecondsSince(const std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// fastest of the runs in milliseconds, finish is called after each run
+// outside the timing
+template<typename TRun, typename TFinish>
+double BestMilliseconds(const int runs, TRun&& run, TFinish&& finish) {
+    double best = 1e30;
+    for (int i = 0; i < runs; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        run();
+        best = std::min(best, MillisecondsSince(start));
+        finish();
+    }
+    return best;
+}
+
+template<typename TRun>
+double BestMilliseconds(const int runs, TRun&& run) {
+    return BestMilliseconds(runs, run, []() {});
+}
+
+// boxes of 8 to maxSize px with about 50x50 px of room each, on whole pixels
+// so the float and double overlap tests agree exactly
+inline std::vector<AABB> MakeBoxes(const int count, const int maxSize, std::mt19937& random) {
+    const int side = static_cast<int>(std::sqrt(static_cast<double>(count)) * 50);
+    std::uniform_int_distribution<int> position(0, side);
+    std::uniform_int_distribution<int> size(8, maxSize);
+    std::vector<AABB> boxes;
+    for (int i = 0; i < count; i++) {
+        const double x = position(random);
+        const double y = position(random);
+        boxes.push_back({x, y, x + size(random), y + size(random)});
+    }
+    return boxes;
+}
+
+#endif // BENCH_UTIL_H
@@ -0,0 +1,102 @@
+// Stress test of ConcurrentEventQueue: several producer threads push
+// millions of events through a small queue while the main thread drains it.
+// Fails unless every event arrives exactly once and each producer's events
+// arrive in the order it emitted them. Build with -DBENCH_TSAN=ON to run it
+// under ThreadSanitizer.
+//
+// usage: concurrent_queue_stress [producers] [events per producer]
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "../src/event_bus/concurrent_event_queue.h"
+#include "bench_util.h"
+
+namespace {
+    struct SequencedEvent {
+        int producer;
+        int sequence;
+
+        SequencedEvent(const int producer, const int sequence) : producer(producer), sequence(sequence) {
+        }
+    };
+}
+
+int main(int argc, char* argv[]) {
+    const int numProducers = argc > 1 ? std::atoi(argv[1]) : 8;
+    const int eventsPerProducer = argc > 2 ? std::atoi(argv[2]) : 500000;
+    const long long totalEvents = static_cast<long long>(numProducers) * eventsPerProducer;
+
+    // small on purpose, producers keep running into a full queue and wrapping around
+    ConcurrentEventQueue<SequencedEvent> queue(1024);
+    std::atomic<bool> start(false);
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < numProducers; producer++) {
+        producers.emplace_back([&queue, &start, producer, eventsPerProducer]() {
+            while (!start.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (int sequence = 0; sequence < eventsPerProducer; sequence++) {
+                // half of the producers retry TryEmit themselves, the other half use Emit
+                if (producer % 2 == 0) {
+                    while (!queue.TryEmit(producer, sequence)) {
+                        std::this_thread::yield();
+                    }
+                } else {
+                    queue.Emit(producer, sequence);
+                }
+            }
+        });
+    }
+
+    std::vector<int> nextSequence(numProducers, 0);
+    long long received = 0;
+    long long outOfOrder = 0;
+    const auto startTime = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    while (received < totalEvents) {
+        const size_t drained = queue.Drain([&](SequencedEvent&& event) {
+            if (event.producer < 0 || event.producer >= numProducers ||
+                event.sequence != nextSequence[event.producer]) {
+                outOfOrder++;
+            } else {
+                nextSequence[event.producer]++;
+            }
+            received++;
+        });
+        if (drained == 0) {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& producer: producers) {
+        producer.join();
+    }
+    const double seconds = SecondsSince(startTime);
+
+    // nothing may show up after the last expected event
+    queue.Drain([&](SequencedEvent&&) { received++; });
+
+    std::printf("%d producers, %lld events in %.2f s (%.1fM events/s)\n", numProducers, totalEvents, seconds,
+                totalEvents / seconds / 1e6);
+    int failures = 0;
+    if (received != totalEvents) {
+        std::printf("FAIL: received %lld of %lld events\n", received, totalEvents);
+        failures++;
+    }
+    if (outOfOrder > 0) {
+        std::printf("FAIL: %lld events out of order or from an unknown producer\n", outOfOrder);
+        failures++;
+    }
+    for (int producer = 0; producer < numProducers; producer++) {
+        if (nextSequence[producer] != eventsPerProducer) {
+            std::printf("FAIL: producer %d delivered %d of %d events in order\n", producer,
+                        nextSequence[producer], eventsPerProducer);
+            failures++;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
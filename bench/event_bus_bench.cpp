@@ -0,0 +1,93 @@
+// Events per second through EventBus::EmitEvent for 1 to 64 trivial
+// handlers, and through a queued EventChannel for comparison. Fails if a
+// handler missed an event or saw the wrong payload.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "../src/event_bus/event.h"
+#include "../src/event_bus/event_bus.h"
+#include "bench_util.h"
+
+namespace {
+    constexpr int NUM_EVENTS = 2000000;
+
+    class PairEvent : public Event {
+    public:
+        int a;
+        int b;
+
+        PairEvent(const int a, const int b) : a(a), b(b) {
+        }
+    };
+
+    class Handler {
+    public:
+        int64_t sum = 0;
+        int count = 0;
+
+        void OnPair(PairEvent& e) {
+            sum += e.a + e.b;
+            count++;
+        }
+    };
+}
+
+int main() {
+    // sum of a + b over the emitted events, what every handler must end up with
+    const int64_t expectedSum = static_cast<int64_t>(NUM_EVENTS) * (NUM_EVENTS - 1) / 2 + NUM_EVENTS;
+    int failures = 0;
+
+    std::printf("handlers   events/s (EmitEvent)\n");
+    for (const int numHandlers: {1, 4, 16, 64}) {
+        EventBus eventBus;
+        std::vector<Handler> handlers(numHandlers);
+        std::vector<EventSubscription> subscriptions;
+        for (auto& handler: handlers) {
+            subscriptions.push_back(eventBus.SubscribeToEvent<&Handler::OnPair>(&handler));
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < NUM_EVENTS; i++) {
+            eventBus.EmitEvent<PairEvent>(i, 1);
+        }
+        const double seconds = SecondsSince(start);
+        std::printf("%-10d %.1fM\n", numHandlers, NUM_EVENTS / seconds / 1e6);
+
+        for (const auto& handler: handlers) {
+            if (handler.count != NUM_EVENTS || handler.sum != expectedSum) {
+                std::printf("FAIL: a handler saw %d events, sum %lld\n", handler.count,
+                            static_cast<long long>(handler.sum));
+                failures++;
+            }
+        }
+    }
+
+    // the queued path, emitted in batches of a frame's worth and read back
+    EventBus eventBus;
+    auto& channel = eventBus.GetChannel<PairEvent>();
+    constexpr int eventsPerFrame = 10000;
+    int64_t sum = 0;
+    int count = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < NUM_EVENTS; i += eventsPerFrame) {
+        for (int j = i; j < i + eventsPerFrame; j++) {
+            channel.Emit(j, 1);
+        }
+        eventBus.SwapChannels();
+        for (const auto& e: channel.Read()) {
+            sum += e.a + e.b;
+            count++;
+        }
+    }
+    const double seconds = SecondsSince(start);
+    std::printf("channel    %.1fM\n", NUM_EVENTS / seconds / 1e6);
+    if (count != NUM_EVENTS || sum != expectedSum) {
+        std::printf("FAIL: the channel delivered %d events, sum %lld\n", count, static_cast<long long>(sum));
+        failures++;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+// Heap allocations per frame for the game's event pattern: four handlers on
+// two event types and 10 emits a frame. Compares resubscribing every frame
+// after a Reset, as Game::Update used to, with subscriptions kept for the
+// whole level, and with one handler dropping and taking back its
+// subscription every frame. Fails if either of the last two allocates once
+// warmed up.
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "../src/event_bus/event.h"
+#include "../src/event_bus/event_bus.h"
+
+namespace {
+    constexpr int NUM_FRAMES = 1000;
+    constexpr int WARMUP_FRAMES = 10;
+    constexpr int EMITS_PER_FRAME = 10;
+
+    // the bench is single threaded, a plain counter is enough
+    long long allocations = 0;
+}
+
+void* operator new(const std::size_t size) {
+    allocations++;
+    if (void* memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+namespace {
+    class HitEvent : public Event {
+    public:
+        int damage;
+
+        explicit HitEvent(const int damage) : damage(damage) {
+        }
+    };
+
+    class KeyEvent : public Event {
+    public:
+        int key;
+
+        explicit KeyEvent(const int key) : key(key) {
+        }
+    };
+
+    class Handler {
+    public:
+        long long sum = 0;
+
+        void OnHit(HitEvent& e) {
+            sum += e.damage;
+        }
+
+        void OnKey(KeyEvent& e) {
+            sum += e.key;
+        }
+    };
+
+    struct Subscriptions {
+        EventSubscription hits[2];
+        EventSubscription keys[2];
+    };
+
+    void Subscribe(EventBus& eventBus, Handler* handlers, Subscriptions& subscriptions) {
+        for (int i = 0; i < 2; i++) {
+            subscriptions.hits[i] = eventBus.SubscribeToEvent<&Handler::OnHit>(&handlers[i]);
+            subscriptions.keys[i] = eventBus.SubscribeToEvent<&Handler::OnKey>(&handlers[i + 2]);
+        }
+    }
+
+    void EmitFrame(EventBus& eventBus) {
+        for (int i = 0; i < EMITS_PER_FRAME / 2; i++) {
+            eventBus.EmitEvent<HitEvent>(1);
+            eventBus.EmitEvent<KeyEvent>(1);
+        }
+    }
+
+    // allocations per frame once warmed up, and whether every handler saw
+    // every event meant for it
+    template<typename TFrame>
+    double AllocationsPerFrame(TFrame&& frame, const Handler* handlers, bool& isDelivered) {
+        for (int i = 0; i < WARMUP_FRAMES; i++) {
+            frame();
+        }
+        const long long before = allocations;
+        for (int i = 0; i < NUM_FRAMES; i++) {
+            frame();
+        }
+        const double perFrame = static_cast<double>(allocations - before) / NUM_FRAMES;
+
+        constexpr long long expected = static_cast<long long>(WARMUP_FRAMES + NUM_FRAMES) * EMITS_PER_FRAME / 2;
+        isDelivered = true;
+        for (int i = 0; i < 4; i++) {
+            isDelivered = isDelivered && handlers[i].sum == expected;
+        }
+        return perFrame;
+    }
+}
+
+int main() {
+    int failures = 0;
+    bool isDelivered = false;
+    double resubscribed = 0;
+    double persistent = 0;
+    double reused = 0;
+
+    {
+        EventBus eventBus;
+        Handler handlers[4];
+        Subscriptions subscriptions;
+        resubscribed = AllocationsPerFrame([&]() {
+            eventBus.Reset();
+            Subscribe(eventBus, handlers, subscriptions);
+            EmitFrame(eventBus);
+        }, handlers, isDelivered);
+        if (!isDelivered) {
+            std::printf("FAIL: a handler missed events after resubscribing\n");
+            failures++;
+        }
+    }
+    {
+        EventBus eventBus;
+        Handler handlers[4];
+        Subscriptions subscriptions;
+        Subscribe(eventBus, handlers, subscriptions);
+        persistent = AllocationsPerFrame([&]() {
+            EmitFrame(eventBus);
+        }, handlers, isDelivered);
+        if (persistent != 0 || !isDelivered) {
+            std::printf("FAIL: emitting to persistent subscriptions allocated or missed events\n");
+            failures++;
+        }
+    }
+    {
+        EventBus eventBus;
+        Handler handlers[4];
+        Subscriptions subscriptions;
+        Subscribe(eventBus, handlers, subscriptions);
+        reused = AllocationsPerFrame([&]() {
+            subscriptions.hits[0].Unsubscribe();
+            subscriptions.hits[0] = eventBus.SubscribeToEvent<&Handler::OnHit>(&handlers[0]);
+            EmitFrame(eventBus);
+        }, handlers, isDelivered);
+        if (reused != 0 || !isDelivered) {
+            std::printf("FAIL: reusing a freed subscription slot allocated or missed events\n");
+            failures++;
+        }
+    }
+
+    // printed at the end, the event buses log as they are created
+    std::printf("pattern                    allocations/frame\n");
+    std::printf("reset and resubscribe      %.1f\n", resubscribed);
+    std::printf("persistent subscriptions   %.1f\n", persistent);
+    std::printf("unsubscribe and subscribe  %.1f\n", reused);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+// MovementSystem::Update on 100k moving entities for 100 steps, next to the
+// IntegrateMotion kernel alone. Fails unless every position matches a plain
+// position += velocity * deltaTime loop and exactly the entities that left
+// the map were destroyed.
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../src/components/rigid_body_component.h"
+#include "../src/components/transform_component.h"
+#include "../src/ecs/ecs.h"
+#include "../src/game/activity_regions.h"
+#include "../src/physics/motion_batch.h"
+#include "../src/systems/movement_system.h"
+#include "../src/timing/frame_clock.h"
+#include "bench_util.h"
+
+namespace {
+    constexpr int NUM_ENTITIES = 100000;
+    constexpr int NUM_STEPS = 100;
+    constexpr float DELTA_TIME = 1.f / 60;
+    constexpr int MAP_SIZE = 8000;
+}
+
+int main() {
+    auto registry = std::make_unique<Registry>();
+    registry->AddSystem<MovementSystem>();
+    registry->SortPoolLike<RigidBodyComponent, TransformComponent>();
+    registry->IterateSystemsInPoolOrder<TransformComponent>();
+
+    // a few near the edge head out of the map and get destroyed on the way
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> position(100, MAP_SIZE - 100);
+    std::uniform_real_distribution<float> speed(-50, 50);
+    std::vector<glm::vec2> expectedPositions;
+    std::vector<glm::vec2> velocities;
+    for (int i = 0; i < NUM_ENTITIES; i++) {
+        Entity entity = registry->CreateEntity();
+        const glm::vec2 at = i % 100 == 0 ? glm::vec2(5, position(random)) : glm::vec2(position(random), position(random));
+        const glm::vec2 velocity = i % 100 == 0 ? glm::vec2(-60, 0) : glm::vec2(speed(random), speed(random));
+        entity.AddComponent<TransformComponent>(at);
+        entity.AddComponent<RigidBodyComponent>(velocity);
+        expectedPositions.push_back(at);
+        velocities.push_back(velocity);
+    }
+    registry->Update();
+
+    ActivityRegions regions;
+    regions.Reset(MAP_SIZE, MAP_SIZE);
+    regions.SetEnabled(false);
+    const MotionBounds mapBounds{0, 0, static_cast<float>(MAP_SIZE), static_cast<float>(MAP_SIZE)};
+    auto& movementSystem = registry->GetSystem<MovementSystem>();
+
+    double updateMs = 0;
+    for (int step = 0; step < NUM_STEPS; step++) {
+        FrameClock::Step();
+        regions.Update(SDL_Rect{0, 0, MAP_SIZE, MAP_SIZE});
+        const auto start = std::chrono::steady_clock::now();
+        movementSystem.Update(registry, DELTA_TIME, regions, mapBounds);
+        updateMs += MillisecondsSince(start);
+        registry->Update();
+    }
+
+    // the reference, an entity is gone once a step takes it out of the map
+    std::vector<bool> isExpectedAlive(NUM_ENTITIES, true);
+    for (int i = 0; i < NUM_ENTITIES; i++) {
+        for (int step = 0; step < NUM_STEPS && isExpectedAlive[i]; step++) {
+            auto& p = expectedPositions[i];
+            p.x = p.x + velocities[i].x * DELTA_TIME;
+            p.y = p.y + velocities[i].y * DELTA_TIME;
+            isExpectedAlive[i] = p.x >= 0 && p.y >= 0 && p.x <= MAP_SIZE && p.y <= MAP_SIZE;
+        }
+    }
+    int mismatches = 0;
+    int destroyed = 0;
+    const auto& transforms = *registry->GetComponentPool<TransformComponent>();
+    for (int i = 0; i < NUM_ENTITIES; i++) {
+        const bool isAlive = transforms.Contains(i);
+        destroyed += !isAlive;
+        if (isAlive != isExpectedAlive[i] || (isAlive && transforms.Get(i).position != expectedPositions[i])) {
+            mismatches++;
+        }
+    }
+
+    // the kernel alone on the same number of bodies
+    MotionArrays motion;
+    motion.Resize(NUM_ENTITIES);
+    for (int i = 0; i < NUM_ENTITIES; i++) {
+        motion.Set(i, expectedPositions[i], velocities[i]);
+    }
+    std::vector<int> outOfBounds;
+    double kernelMs = 0;
+    for (int step = 0; step < NUM_STEPS; step++) {
+        outOfBounds.clear();
+        const auto start = std::chrono::steady_clock::now();
+        IntegrateMotion(motion, DELTA_TIME, mapBounds, outOfBounds);
+        kernelMs += MillisecondsSince(start);
+    }
+
+    std::printf("%d entities, %d steps: Update %.3f ms, IntegrateMotion alone %.3f ms, %d destroyed\n",
+                NUM_ENTITIES, NUM_STEPS, updateMs / NUM_STEPS, kernelMs / NUM_STEPS, destroyed);
+    if (mismatches > 0) {
+        std::printf("FAIL: %d entities differ from the reference loop\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,67 @@
+// Narrowphase over the grid's candidate pairs: the double AABB::Overlaps
+// loop, the scalar float batch and FindOverlappingPairs (AVX2/SSE2 where the
+// CPU has them), best of 30 runs. Fails unless all three find the same pairs.
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "../src/collision/aabb_batch.h"
+#include "../src/collision/uniform_grid.h"
+#include "bench_util.h"
+
+namespace {
+    constexpr int RUNS = 30;
+}
+
+int main() {
+    std::mt19937 random(1234);
+    UniformGrid grid;
+    AABBArrays arrays;
+    std::vector<std::pair<int, int>> candidates;
+    std::vector<std::pair<int, int>> doubleHits;
+    std::vector<std::pair<int, int>> scalarHits;
+    std::vector<std::pair<int, int>> simdHits;
+    int failures = 0;
+
+    std::printf("boxes  candidates  hit%%   double     scalar     SIMD       speedup\n");
+    for (const auto& [count, maxSize]: {std::pair{2000, 64}, {10000, 64}, {10000, 32}, {50000, 64}, {50000, 32}}) {
+        const auto boxes = MakeBoxes(count, maxSize, random);
+        candidates.clear();
+        grid.Build(boxes);
+        grid.FindPairs(candidates);
+        arrays.Clear();
+        for (const auto& box: boxes) {
+            arrays.Add(box);
+        }
+
+        const double doubleUs = 1000 * BestMilliseconds(RUNS, [&]() {
+            doubleHits.clear();
+            for (const auto& candidate: candidates) {
+                if (AABB::Overlaps(boxes[candidate.first], boxes[candidate.second])) {
+                    doubleHits.push_back(candidate);
+                }
+            }
+        });
+        const double scalarUs = 1000 * BestMilliseconds(RUNS, [&]() {
+            scalarHits.clear();
+            FindOverlappingPairsScalar(arrays, candidates, 0, scalarHits);
+        });
+        const double simdUs = 1000 * BestMilliseconds(RUNS, [&]() {
+            simdHits.clear();
+            FindOverlappingPairs(arrays, candidates, simdHits);
+        });
+
+        std::printf("%-6d %-11zu %-6.0f %-10.1f %-10.1f %-10.1f %.1fx\n", count, candidates.size(),
+                    100.0 * doubleHits.size() / std::max<size_t>(1, candidates.size()), doubleUs, scalarUs, simdUs,
+                    doubleUs / simdUs);
+        if (scalarHits != doubleHits || simdHits != doubleHits) {
+            std::printf("FAIL: the paths disagree (%zu double, %zu scalar, %zu SIMD hits)\n", doubleHits.size(),
+                        scalarHits.size(), simdHits.size());
+            failures++;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+// BoxColliderSystem::Update with 1 to 16 worker threads, on worlds of 2k to
+// 50k colliders where 20% are fast movers and 20% static. Best of the frames
+// per thread count. Fails unless every thread count emits exactly the
+// collision events of the single threaded run.
+
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../src/components/box_collider_component.h"
+#include "../src/components/fast_mover_component.h"
+#include "../src/components/rigid_body_component.h"
+#include "../src/components/transform_component.h"
+#include "../src/ecs/ecs.h"
+#include "../src/event_bus/event_bus.h"
+#include "../src/jobs/worker_pool.h"
+#include "../src/systems/box_collider_system.h"
+#include "../src/systems/static_collider_system.h"
+#include "bench_util.h"
+
+namespace {
+    constexpr int NUM_FRAMES = 14;
+
+    struct RecordedCollision {
+        int a;
+        int b;
+        float timeOfImpact;
+
+        bool operator ==(const RecordedCollision& other) const {
+            return a == other.a && b == other.b && timeOfImpact == other.timeOfImpact;
+        }
+    };
+
+    // the same world for a given count, whatever the thread count
+    void PopulateWorld(Registry& registry, const int count) {
+        std::mt19937 random(count);
+        const auto boxes = MakeBoxes(count, 48, random);
+        std::uniform_real_distribution<float> speed(-3, 3);
+        for (int i = 0; i < count; i++) {
+            Entity entity = registry.CreateEntity();
+            const glm::vec2 at(boxes[i].minX, boxes[i].minY);
+            entity.AddComponent<TransformComponent>(at);
+            entity.AddComponent<BoxColliderComponent>(static_cast<int>(boxes[i].maxX - boxes[i].minX),
+                                                      static_cast<int>(boxes[i].maxY - boxes[i].minY));
+            const int kind = i % 5;
+            if (kind == 0) {
+                continue;
+            }
+            if (kind == 1) {
+                entity.AddComponent<RigidBodyComponent>(glm::vec2(speed(random), speed(random)) * 40.f);
+                entity.AddComponent<FastMoverComponent>(at);
+            } else {
+                entity.AddComponent<RigidBodyComponent>(glm::vec2(speed(random), speed(random)));
+            }
+        }
+        registry.Update();
+    }
+
+    void MoveBodies(Registry& registry) {
+        auto& transforms = *registry.GetComponentPool<TransformComponent>();
+        const auto& rigidBodies = *registry.GetComponentPool<RigidBodyComponent>();
+        for (int i = 0; i < rigidBodies.GetSize(); i++) {
+            transforms.Get(rigidBodies.GetEntityIDAt(i)).position += rigidBodies[i].velocity;
+        }
+    }
+
+    // runs the frames, returns the best frame time and fills the events
+    double RunFrames(const int count, const int threadCount, std::vector<RecordedCollision>& events) {
+        Registry registry;
+        registry.AddSystem<StaticColliderSystem>();
+        registry.AddSystem<BoxColliderSystem>();
+        PopulateWorld(registry, count);
+        auto eventBus = std::make_unique<EventBus>();
+        WorkerPool workers(threadCount);
+        auto& boxColliders = registry.GetSystem<BoxColliderSystem>();
+        auto& staticColliders = registry.GetSystem<StaticColliderSystem>();
+
+        events.clear();
+        MoveBodies(registry);
+        return BestMilliseconds(NUM_FRAMES, [&]() {
+            boxColliders.Update(eventBus, staticColliders, workers);
+        }, [&]() {
+            eventBus->SwapChannels();
+            for (const auto& collision: eventBus->GetChannel<CollisionEvent>().Read()) {
+                events.push_back({collision.a.GetID(), collision.b.GetID(), collision.timeOfImpact});
+            }
+            MoveBodies(registry);
+        });
+    }
+}
+
+int main() {
+    std::vector<RecordedCollision> serialEvents;
+    std::vector<RecordedCollision> events;
+    int failures = 0;
+
+    constexpr int counts[] = {2000, 10000, 50000};
+    constexpr int threadCounts[] = {1, 2, 4, 8, 16};
+    std::vector<std::vector<double>> table;
+    std::vector<size_t> eventCounts;
+    for (const int count: counts) {
+        auto& row = table.emplace_back();
+        for (const int threadCount: threadCounts) {
+            row.push_back(RunFrames(count, threadCount, threadCount == 1 ? serialEvents : events));
+            if (threadCount != 1 && events != serialEvents) {
+                std::printf("FAIL: %d threads emitted different events than 1 (%zu vs %zu) with %d colliders\n",
+                            threadCount, events.size(), serialEvents.size(), count);
+                failures++;
+            }
+        }
+        eventCounts.push_back(serialEvents.size());
+    }
+
+    // printed at the end, the worker pools log while the frames run
+    std::printf("colliders  events    1 thread   2          4          8          16\n");
+    for (size_t i = 0; i < table.size(); i++) {
+        std::printf("%-10d %-9zu", counts[i], eventCounts[i]);
+        for (const double ms: table[i]) {
+            std::printf(" %-10.2f", ms);
+        }
+        std::printf("\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+// Snapshot capture/restore on a 50k entity world where a frame only moves
+// the transforms. Reads go through ReadComponent, so capture should copy the
+// transform pool and skip the others. Fails if a read-only pool got copied.
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+
+#include "../src/ecs/ecs.h"
+#include "../src/components/box_collider_component.h"
+#include "../src/components/health_component.h"
+#include "../src/components/rigid_body_component.h"
+#include "../src/components/sprite_component.h"
+#include "../src/components/transform_component.h"
+#include "bench_util.h"
+
+namespace {
+    constexpr int NUM_ENTITIES = 50000;
+    constexpr int NUM_FRAMES = 100;
+
+    class GameLikeSystem : public System {
+    public:
+        GameLikeSystem() {
+            RequireComponent<TransformComponent>();
+            RequireComponent<RigidBodyComponent>();
+            RequireComponent<SpriteComponent>();
+            RequireComponent<BoxColliderComponent>();
+            RequireComponent<HealthComponent>();
+        }
+
+        // what movement, collision and rendering do to these pools in a frame
+        void Update(const float deltaTime, const bool readWithGetComponent) const {
+            for (auto entity: GetEntities()) {
+                glm::vec2 velocity;
+                int extent;
+                if (readWithGetComponent) {
+                    velocity = entity.GetComponent<RigidBodyComponent>().velocity;
+                    extent = entity.GetComponent<SpriteComponent>().width +
+                             entity.GetComponent<BoxColliderComponent>().width +
+                             entity.GetComponent<HealthComponent>().healthPercentage;
+                } else {
+                    velocity = entity.ReadComponent<RigidBodyComponent>().velocity;
+                    extent = entity.ReadComponent<SpriteComponent>().width +
+                             entity.ReadComponent<BoxColliderComponent>().width +
+                             entity.ReadComponent<HealthComponent>().healthPercentage;
+                }
+                auto& transform = entity.GetComponent<TransformComponent>();
+                transform.position += velocity * deltaTime;
+                transform.rotation = extent;
+            }
+        }
+    };
+
+    template<typename TComponent>
+    unsigned long long VersionOf(Registry& registry) {
+        return registry.GetComponentPool<TComponent>()->GetVersion();
+    }
+}
+
+int main() {
+    Registry registry;
+    registry.AddSystem<GameLikeSystem>();
+    for (int i = 0; i < NUM_ENTITIES; i++) {
+        Entity entity = registry.CreateEntity();
+        entity.AddComponent<TransformComponent>(glm::vec2(i % 1000, i / 1000));
+        entity.AddComponent<RigidBodyComponent>(glm::vec2(i % 7, i % 5));
+        entity.AddComponent<SpriteComponent>("tank-image", 32, 32);
+        entity.AddComponent<BoxColliderComponent>(32, 32);
+        entity.AddComponent<HealthComponent>(100);
+    }
+    registry.Update();
+    const auto& system = registry.GetSystem<GameLikeSystem>();
+
+    RegistrySnapshot snapshot;
+    registry.CaptureSnapshot(snapshot);
+
+    int failures = 0;
+    for (const bool readWithGetComponent: {false, true}) {
+        double captureMs = 0;
+        double restoreMs = 0;
+        for (int frame = 0; frame < NUM_FRAMES; frame++) {
+            const auto spriteVersion = VersionOf<SpriteComponent>(registry);
+            const auto transformVersion = VersionOf<TransformComponent>(registry);
+            system.Update(1.f / 60, readWithGetComponent);
+            if (!readWithGetComponent && VersionOf<SpriteComponent>(registry) != spriteVersion) {
+                std::printf("FAIL: reading sprites changed the sprite pool version\n");
+                failures++;
+            }
+            if (VersionOf<TransformComponent>(registry) == transformVersion) {
+                std::printf("FAIL: moving the transforms kept the transform pool version\n");
+                failures++;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            registry.CaptureSnapshot(snapshot);
+            captureMs += MillisecondsSince(start);
+
+            // speculative frame thrown away again
+            const glm::vec2 captured = registry.ReadComponent<TransformComponent>(Entity(0)).position;
+            system.Update(1.f / 60, readWithGetComponent);
+            start = std::chrono::steady_clock::now();
+            registry.RestoreSnapshot(snapshot);
+            restoreMs += MillisecondsSince(start);
+            if (registry.ReadComponent<TransformComponent>(Entity(0)).position != captured) {
+                std::printf("FAIL: restore did not bring the transforms back\n");
+                failures++;
+            }
+        }
+        std::printf("%-28s %d entities: capture %.3f ms, restore %.3f ms\n",
+                    readWithGetComponent ? "reads dirty every pool" : "reads leave pools clean",
+                    NUM_ENTITIES, captureMs / NUM_FRAMES, restoreMs / NUM_FRAMES);
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -2,9 +2,38 @@
 // Created by hector on 11/6/23.
 //
 #include "asset_store.h"
+
+#include <algorithm>
+
 #include "../logger/logger.h"
 #include "SDL2/SDL_image.h"
 
+// pixels at least this opaque are solid in the collision masks
+constexpr Uint8 MASK_ALPHA_THRESHOLD = 128;
+
+// the opaque pixels of a surface, read once while the pixels are still in memory
+static PixelMask CreateAlphaMask(SDL_Surface* surface) {
+    PixelMask mask(surface->w, surface->h);
+    SDL_Surface* rgba = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+    if (!rgba) {
+        Logger::Err("Failed to read the alpha channel of a texture, its collision mask is empty");
+        return mask;
+    }
+    SDL_LockSurface(rgba);
+    for (int y = 0; y < rgba->h; y++) {
+        // RGBA32 is R, G, B, A in memory whatever the endianness
+        const auto* row = static_cast<const Uint8*>(rgba->pixels) + y * rgba->pitch;
+        for (int x = 0; x < rgba->w; x++) {
+            if (row[x * 4 + 3] >= MASK_ALPHA_THRESHOLD) {
+                mask.Set(x, y);
+            }
+        }
+    }
+    SDL_UnlockSurface(rgba);
+    SDL_FreeSurface(rgba);
+    return mask;
+}
+
 AssetStore::AssetStore() {
     Logger::Log("Asset store constructor");
 }
@@ -19,6 +48,8 @@ void AssetStore::ClearAssets() {
         SDL_DestroyTexture(texture.second);
     }
     textures.clear();
+    textureMasks.clear();
+    spriteMasks.clear();
 
     for (auto font: fonts) {
         TTF_CloseFont(font.second);
@@ -34,6 +65,7 @@ void AssetStore::AddTexture(SDL_Renderer* renderer, const std::string& assetID,
     }
     // todo(hector) -  do error checking in case loading fails
     SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    textureMasks[assetID] = CreateAlphaMask(surface);
     SDL_FreeSurface(surface);
 
     textures.emplace(assetID, texture);
@@ -44,6 +76,36 @@ SDL_Texture* AssetStore::GetTexture(const std::string& assetID) {
     return textures[assetID];
 }
 
+const SpriteMasks* AssetStore::GetSpriteMasks(const std::string& assetID, const int frameWidth,
+                                              const int frameHeight) {
+    const std::string key = assetID + "@" + std::to_string(frameWidth) + "x" + std::to_string(frameHeight);
+    if (const auto cached = spriteMasks.find(key); cached != spriteMasks.end()) {
+        return &cached->second;
+    }
+    const auto textureMask = textureMasks.find(assetID);
+    if (textureMask == textureMasks.end() || frameWidth <= 0 || frameHeight <= 0) {
+        return nullptr;
+    }
+
+    SpriteMasks& masks = spriteMasks[key];
+    masks.frameWidth = frameWidth;
+    masks.frameHeight = frameHeight;
+    masks.columns = std::max(1, textureMask->second.GetWidth() / frameWidth);
+    masks.rows = std::max(1, textureMask->second.GetHeight() / frameHeight);
+    for (int row = 0; row < masks.rows; row++) {
+        for (int column = 0; column < masks.columns; column++) {
+            const PixelMask frame = textureMask->second.Cropped(column * frameWidth, row * frameHeight,
+                                                                frameWidth, frameHeight);
+            // same order as the SDL_RendererFlip bits
+            masks.frames.push_back(frame);
+            masks.frames.push_back(frame.Flipped(true, false));
+            masks.frames.push_back(frame.Flipped(false, true));
+            masks.frames.push_back(frame.Flipped(true, true));
+        }
+    }
+    return &masks;
+}
+
 void AssetStore::AddFont(const std::string& assetID, const std::string& filePath, int fontSize) {
     fonts.emplace(assetID, TTF_OpenFont(filePath.c_str(), fontSize));
 }
@@ -10,10 +10,16 @@
 #include <map>
 #include <string>
 
+#include "../collision/pixel_mask.h"
+
 class AssetStore {
 private:
     std::map<std::string, SDL_Texture*> textures;
     std::map<std::string, TTF_Font*> fonts;
+    // opaque pixels of every texture, read from the surface while loading it
+    std::map<std::string, PixelMask> textureMasks;
+    // key = asset id and frame size, see GetSpriteMasks
+    std::map<std::string, SpriteMasks> spriteMasks;
 
 public:
     AssetStore();
@@ -24,6 +30,10 @@ public:
     void AddTexture(SDL_Renderer* renderer, const std::string& assetID, const std::string& filePath);
     SDL_Texture* GetTexture(const std::string& assetID);
 
+    // the collision masks of the frames of a texture cut into frames of the
+    // given size, cut on the first call and cached. nullptr for unknown textures.
+    const SpriteMasks* GetSpriteMasks(const std::string& assetID, int frameWidth, int frameHeight);
+
     void AddFont(const std::string& assetID, const std::string& filePath, int fontSize);
     TTF_Font* GetFont(const std::string& assetID);
 };
@@ -0,0 +1,106 @@
+#ifndef AABB_H
+#define AABB_H
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "../components/box_collider_component.h"
+#include "../components/transform_component.h"
+
+// axis aligned box in world space, in doubles. Every box test of the collision
+// code goes through AABB::Overlaps, so they all agree on edges that only touch.
+struct AABB {
+    double minX;
+    double minY;
+    double maxX;
+    double maxY;
+
+    static AABB FromCollider(const TransformComponent& transform, const BoxColliderComponent& collider) {
+        const double x = transform.position.x + collider.offset.x;
+        const double y = transform.position.y + collider.offset.y;
+        return {x, y, x + collider.width, y + collider.height};
+    }
+
+    static bool Overlaps(const AABB& a, const AABB& b) {
+        return a.minX < b.maxX && a.maxX > b.minX && a.minY < b.maxY && a.maxY > b.minY;
+    }
+
+    AABB Translated(const double dx, const double dy) const {
+        return {minX + dx, minY + dy, maxX + dx, maxY + dy};
+    }
+
+    static AABB Union(const AABB& a, const AABB& b) {
+        return {std::min(a.minX, b.minX), std::min(a.minY, b.minY), std::max(a.maxX, b.maxX), std::max(a.maxY, b.maxY)};
+    }
+
+    // Clips the ray origin + direction * t, tMin <= t <= tMax, to the box.
+    // Returns false when they do not meet, otherwise the clipped range. A box
+    // containing the origin is entered at tMin.
+    static bool ClipRay(
+        const AABB& box, const double x, const double y, const double directionX, const double directionY,
+        double& tMin, double& tMax
+    ) {
+        const auto axis = [&tMin, &tMax](const double origin, const double direction, const double min, const double max) {
+            if (direction == 0) {
+                return origin >= min && origin <= max;
+            }
+            double entry = (min - origin) / direction;
+            double exit = (max - origin) / direction;
+            if (direction < 0) {
+                std::swap(entry, exit);
+            }
+            tMin = std::max(tMin, entry);
+            tMax = std::min(tMax, exit);
+            return tMin <= tMax;
+        };
+        return axis(x, directionX, box.minX, box.maxX) && axis(y, directionY, box.minY, box.maxY);
+    }
+
+    // squared distance from a point to the box, 0 inside
+    static double DistanceSquared(const AABB& box, const double x, const double y) {
+        const double dx = std::max({box.minX - x, 0.0, x - box.maxX});
+        const double dy = std::max({box.minY - y, 0.0, y - box.maxY});
+        return dx * dx + dy * dy;
+    }
+
+    // Swept test of two boxes moving in a straight line during one frame,
+    // given their start boxes and their displacements. Returns whether they
+    // overlap at some point of the move and, in timeOfImpact, the fraction of
+    // the move (0 - 1) at which they first do. Same strict rule as Overlaps,
+    // boxes that only touch do not collide.
+    static bool Sweep(
+        const AABB& a, const double aDX, const double aDY,
+        const AABB& b, const double bDX, const double bDY,
+        double& timeOfImpact
+    ) {
+        // move a relative to b, then intersect the time intervals during which
+        // the boxes overlap on each axis
+        double entry = -std::numeric_limits<double>::infinity();
+        double exit = std::numeric_limits<double>::infinity();
+        const auto axis = [&entry, &exit](const double aMin, const double aMax, const double bMin, const double bMax,
+                                          const double velocity) {
+            if (velocity == 0) {
+                return aMin < bMax && aMax > bMin;
+            }
+            double axisEntry = (bMin - aMax) / velocity;
+            double axisExit = (bMax - aMin) / velocity;
+            if (velocity < 0) {
+                std::swap(axisEntry, axisExit);
+            }
+            entry = std::max(entry, axisEntry);
+            exit = std::min(exit, axisExit);
+            return true;
+        };
+        if (!axis(a.minX, a.maxX, b.minX, b.maxX, aDX - bDX) || !axis(a.minY, a.maxY, b.minY, b.maxY, aDY - bDY)) {
+            return false;
+        }
+        if (entry >= exit || entry >= 1 || exit <= 0) {
+            return false;
+        }
+        timeOfImpact = std::max(0.0, entry);
+        return true;
+    }
+};
+
+#endif //AABB_H
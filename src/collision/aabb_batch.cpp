@@ -0,0 +1,122 @@
+#include "aabb_batch.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AABB_BATCH_SSE2
+#include <emmintrin.h>
+#endif
+
+// AVX2 is not part of the baseline flags, the function is compiled for it on
+// its own and only called after checking the CPU at runtime
+#if defined(AABB_BATCH_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define AABB_BATCH_AVX2
+#include <immintrin.h>
+#endif
+
+void FindOverlappingPairsScalar(
+    const AABBArrays& boxes,
+    const std::vector<std::pair<int, int>>& candidates,
+    const size_t first,
+    std::vector<std::pair<int, int>>& overlapping
+) {
+    for (size_t k = first; k < candidates.size(); k++) {
+        const int a = candidates[k].first;
+        const int b = candidates[k].second;
+        if (boxes.minX[a] < boxes.maxX[b] && boxes.maxX[a] > boxes.minX[b] &&
+            boxes.minY[a] < boxes.maxY[b] && boxes.maxY[a] > boxes.minY[b]) {
+            overlapping.push_back(candidates[k]);
+        }
+    }
+}
+
+#ifdef AABB_BATCH_SSE2
+static void FindOverlappingPairsSSE2(
+    const AABBArrays& boxes,
+    const std::vector<std::pair<int, int>>& candidates,
+    std::vector<std::pair<int, int>>& overlapping
+) {
+    const float* minX = boxes.minX.data();
+    const float* minY = boxes.minY.data();
+    const float* maxX = boxes.maxX.data();
+    const float* maxY = boxes.maxY.data();
+    const auto* pairs = candidates.data();
+    size_t k = 0;
+    for (; k + 4 <= candidates.size(); k += 4) {
+        // SSE2 has no gather, the lanes are filled one by one
+        const int a0 = pairs[k].first, a1 = pairs[k + 1].first, a2 = pairs[k + 2].first, a3 = pairs[k + 3].first;
+        const int b0 = pairs[k].second, b1 = pairs[k + 1].second, b2 = pairs[k + 2].second, b3 = pairs[k + 3].second;
+        const __m128 x = _mm_and_ps(
+            _mm_cmplt_ps(_mm_setr_ps(minX[a0], minX[a1], minX[a2], minX[a3]),
+                         _mm_setr_ps(maxX[b0], maxX[b1], maxX[b2], maxX[b3])),
+            _mm_cmpgt_ps(_mm_setr_ps(maxX[a0], maxX[a1], maxX[a2], maxX[a3]),
+                         _mm_setr_ps(minX[b0], minX[b1], minX[b2], minX[b3])));
+        const __m128 y = _mm_and_ps(
+            _mm_cmplt_ps(_mm_setr_ps(minY[a0], minY[a1], minY[a2], minY[a3]),
+                         _mm_setr_ps(maxY[b0], maxY[b1], maxY[b2], maxY[b3])),
+            _mm_cmpgt_ps(_mm_setr_ps(maxY[a0], maxY[a1], maxY[a2], maxY[a3]),
+                         _mm_setr_ps(minY[b0], minY[b1], minY[b2], minY[b3])));
+        const int mask = _mm_movemask_ps(_mm_and_ps(x, y));
+        for (int lane = 0; mask >> lane; lane++) {
+            if (mask & (1 << lane)) {
+                overlapping.push_back(pairs[k + lane]);
+            }
+        }
+    }
+    FindOverlappingPairsScalar(boxes, candidates, k, overlapping);
+}
+#endif
+
+#ifdef AABB_BATCH_AVX2
+__attribute__((target("avx2")))
+static void FindOverlappingPairsAVX2(
+    const AABBArrays& boxes,
+    const std::vector<std::pair<int, int>>& candidates,
+    std::vector<std::pair<int, int>>& overlapping
+) {
+    const float* minX = boxes.minX.data();
+    const float* minY = boxes.minY.data();
+    const float* maxX = boxes.maxX.data();
+    const float* maxY = boxes.maxY.data();
+    const auto* pairs = candidates.data();
+    size_t k = 0;
+    for (; k + 8 <= candidates.size(); k += 8) {
+        const __m256i a = _mm256_setr_epi32(pairs[k].first, pairs[k + 1].first, pairs[k + 2].first,
+                                            pairs[k + 3].first, pairs[k + 4].first, pairs[k + 5].first,
+                                            pairs[k + 6].first, pairs[k + 7].first);
+        const __m256i b = _mm256_setr_epi32(pairs[k].second, pairs[k + 1].second, pairs[k + 2].second,
+                                            pairs[k + 3].second, pairs[k + 4].second, pairs[k + 5].second,
+                                            pairs[k + 6].second, pairs[k + 7].second);
+        const __m256 x = _mm256_and_ps(
+            _mm256_cmp_ps(_mm256_i32gather_ps(minX, a, 4), _mm256_i32gather_ps(maxX, b, 4), _CMP_LT_OQ),
+            _mm256_cmp_ps(_mm256_i32gather_ps(maxX, a, 4), _mm256_i32gather_ps(minX, b, 4), _CMP_GT_OQ));
+        const __m256 y = _mm256_and_ps(
+            _mm256_cmp_ps(_mm256_i32gather_ps(minY, a, 4), _mm256_i32gather_ps(maxY, b, 4), _CMP_LT_OQ),
+            _mm256_cmp_ps(_mm256_i32gather_ps(maxY, a, 4), _mm256_i32gather_ps(minY, b, 4), _CMP_GT_OQ));
+        const int mask = _mm256_movemask_ps(_mm256_and_ps(x, y));
+        for (int lane = 0; mask >> lane; lane++) {
+            if (mask & (1 << lane)) {
+                overlapping.push_back(pairs[k + lane]);
+            }
+        }
+    }
+    FindOverlappingPairsScalar(boxes, candidates, k, overlapping);
+}
+#endif
+
+void FindOverlappingPairs(
+    const AABBArrays& boxes,
+    const std::vector<std::pair<int, int>>& candidates,
+    std::vector<std::pair<int, int>>& overlapping
+) {
+#if defined(AABB_BATCH_AVX2)
+    static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+    if (hasAVX2) {
+        FindOverlappingPairsAVX2(boxes, candidates, overlapping);
+        return;
+    }
+#endif
+#if defined(AABB_BATCH_SSE2)
+    FindOverlappingPairsSSE2(boxes, candidates, overlapping);
+#else
+    FindOverlappingPairsScalar(boxes, candidates, 0, overlapping);
+#endif
+}
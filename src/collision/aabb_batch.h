@@ -0,0 +1,54 @@
+#ifndef AABB_BATCH_H
+#define AABB_BATCH_H
+
+#include <utility>
+#include <vector>
+
+#include "aabb.h"
+
+// Collider bounds as a structure of arrays, index = collider. Floats, so a
+// register holds the coordinate of 4 (SSE2) or 8 (AVX2) boxes at once.
+struct AABBArrays {
+    std::vector<float> minX;
+    std::vector<float> minY;
+    std::vector<float> maxX;
+    std::vector<float> maxY;
+
+    void Clear() {
+        minX.clear();
+        minY.clear();
+        maxX.clear();
+        maxY.clear();
+    }
+
+    void Add(const AABB& box) {
+        minX.push_back(static_cast<float>(box.minX));
+        minY.push_back(static_cast<float>(box.minY));
+        maxX.push_back(static_cast<float>(box.maxX));
+        maxY.push_back(static_cast<float>(box.maxY));
+    }
+
+    int GetSize() const {
+        return static_cast<int>(minX.size());
+    }
+};
+
+// Narrowphase for a batch of candidate pairs: appends the ones whose boxes
+// overlap to overlapping, keeping their order. Tests 8 pairs at a time with
+// AVX2 when the CPU has it, 4 with SSE2 on other x86 CPUs and one at a time
+// everywhere else.
+void FindOverlappingPairs(
+    const AABBArrays& boxes,
+    const std::vector<std::pair<int, int>>& candidates,
+    std::vector<std::pair<int, int>>& overlapping
+);
+
+// the plain C++ version, also used for the leftover pairs of the SIMD versions
+void FindOverlappingPairsScalar(
+    const AABBArrays& boxes,
+    const std::vector<std::pair<int, int>>& candidates,
+    size_t first,
+    std::vector<std::pair<int, int>>& overlapping
+);
+
+#endif //AABB_BATCH_H
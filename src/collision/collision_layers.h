@@ -0,0 +1,58 @@
+#ifndef COLLISION_LAYERS_H
+#define COLLISION_LAYERS_H
+
+#include <cstdint>
+
+#include "../components/box_collider_component.h"
+
+// layer bit of a collider plus the layers it is willing to collide with,
+// precomputed so the broadphase rejects a pair with two ANDs
+struct LayerFilter {
+    uint32_t layerBit = 1;
+    uint32_t mask = ALL_COLLISION_LAYERS;
+
+    static bool Accepts(const LayerFilter& a, const LayerFilter& b) {
+        return (a.layerBit & b.mask) && (b.layerBit & a.mask);
+    }
+};
+
+// Symmetric layer pair matrix, on top of the per collider masks. Everything
+// collides with everything until told otherwise.
+class CollisionLayerMatrix {
+private:
+    // index = layer, bits = layers it collides with
+    uint32_t layerMasks[MAX_COLLISION_LAYERS];
+
+public:
+    CollisionLayerMatrix() {
+        for (auto& layerMask: layerMasks) {
+            layerMask = ALL_COLLISION_LAYERS;
+        }
+    }
+
+    void SetLayersCollide(const int a, const int b, const bool collide) {
+        if (collide) {
+            layerMasks[a] |= 1u << b;
+            layerMasks[b] |= 1u << a;
+        } else {
+            layerMasks[a] &= ~(1u << b);
+            layerMasks[b] &= ~(1u << a);
+        }
+    }
+
+    bool DoLayersCollide(const int a, const int b) const {
+        return layerMasks[a] & (1u << b);
+    }
+
+    // the collider's own mask narrowed down by the matrix. As the matrix is
+    // symmetric, applying it to one side of a pair is enough.
+    LayerFilter GetFilter(const BoxColliderComponent& collider) const {
+        return {1u << collider.layer, collider.mask & layerMasks[collider.layer]};
+    }
+
+    static LayerFilter GetUnfilteredFilter(const BoxColliderComponent& collider) {
+        return {1u << collider.layer, collider.mask};
+    }
+};
+
+#endif //COLLISION_LAYERS_H
@@ -0,0 +1,90 @@
+#include "contact_cache.h"
+
+#include <algorithm>
+#include <utility>
+
+// the table is grown to keep it at most half full, probe sequences stay short
+constexpr size_t MIN_SLOTS = 64;
+
+uint64_t ContactCache::MakeKey(const Entity a, const Entity b) {
+    const auto low = static_cast<uint32_t>(std::min(a.GetID(), b.GetID()));
+    const auto high = static_cast<uint32_t>(std::max(a.GetID(), b.GetID()));
+    return static_cast<uint64_t>(high) << 32 | low;
+}
+
+// 64 bit finalizer of MurmurHash3, entity ids are small and dense so the
+// key's bits need mixing before masking
+static size_t Hash(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return static_cast<size_t>(key);
+}
+
+int ContactCache::Find(const std::vector<int>& table, const std::vector<Contact>& tableContacts, const uint64_t key) {
+    if (table.empty()) {
+        return -1;
+    }
+    const size_t mask = table.size() - 1;
+    for (size_t slot = Hash(key) & mask;; slot = (slot + 1) & mask) {
+        const int index = table[slot];
+        if (index == -1 || tableContacts[index].key == key) {
+            return index;
+        }
+    }
+}
+
+void ContactCache::Grow() {
+    slots.assign(std::max(MIN_SLOTS, slots.size() * 2), -1);
+    const size_t mask = slots.size() - 1;
+    for (int index = 0; index < static_cast<int>(contacts.size()); index++) {
+        size_t slot = Hash(contacts[index].key) & mask;
+        while (slots[slot] != -1) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = index;
+    }
+}
+
+void ContactCache::BeginFrame() {
+    std::swap(contacts, previousContacts);
+    std::swap(slots, previousSlots);
+    contacts.clear();
+    // sized for as many contacts as last frame, so a steady scene does not rehash
+    size_t size = MIN_SLOTS;
+    while (size < previousContacts.size() * 2) {
+        size *= 2;
+    }
+    slots.assign(size, -1);
+}
+
+bool ContactCache::Add(const Entity a, const Entity b, const uint64_t aLabels, const uint64_t bLabels) {
+    if ((contacts.size() + 1) * 2 > slots.size()) {
+        Grow();
+    }
+    const uint64_t key = MakeKey(a, b);
+    const size_t mask = slots.size() - 1;
+    size_t slot = Hash(key) & mask;
+    while (slots[slot] != -1) {
+        if (contacts[slots[slot]].key == key) {
+            return true;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    const int previous = Find(previousSlots, previousContacts, key);
+    Contact contact{key, a, b, aLabels, bLabels};
+    if (previous != -1) {
+        // keep the order the pair was first reported in
+        contact.a = previousContacts[previous].a;
+        contact.b = previousContacts[previous].b;
+        if (contact.a != a) {
+            std::swap(contact.aLabels, contact.bLabels);
+        }
+    }
+    slots[slot] = static_cast<int>(contacts.size());
+    contacts.push_back(contact);
+    return previous != -1;
+}
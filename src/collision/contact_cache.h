@@ -0,0 +1,63 @@
+#ifndef CONTACT_CACHE_H
+#define CONTACT_CACHE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "../ecs/ecs.h"
+
+// The set of touching pairs, kept between frames so collisions can be
+// reported as they start and end instead of every frame they last. Pairs are
+// keyed by the two entity ids, smallest first, in an open addressing table.
+// Each frame is built into a fresh table and looked up in the last one, which
+// avoids deletions and tombstones altogether.
+class ContactCache {
+public:
+    struct Contact {
+        uint64_t key;
+        // as reported the frame the contact started
+        Entity a;
+        Entity b;
+        // the entities' EntityLabels bits the last frame they touched
+        uint64_t aLabels;
+        uint64_t bLabels;
+    };
+
+private:
+    // contacts in the order they were added, the tables index into them
+    std::vector<Contact> contacts;
+    std::vector<Contact> previousContacts;
+    // -1 = empty, power of two sized
+    std::vector<int> slots;
+    std::vector<int> previousSlots;
+
+    static uint64_t MakeKey(Entity a, Entity b);
+    static int Find(const std::vector<int>& table, const std::vector<Contact>& tableContacts, uint64_t key);
+    void Grow();
+
+public:
+    // starts a new frame, the contacts of the current one become the previous ones
+    void BeginFrame();
+
+    // records a touching pair for this frame, returns whether it was already
+    // touching last frame. Adding the same pair twice in a frame is a no-op
+    // that also returns true.
+    bool Add(Entity a, Entity b, uint64_t aLabels, uint64_t bLabels);
+
+    // calls callback(contact) for each pair touching last frame but not in
+    // this one, in the order they were added last frame
+    template<typename TCallback>
+    void ForEachEnded(TCallback&& callback) const {
+        for (const auto& contact: previousContacts) {
+            if (Find(slots, contacts, contact.key) == -1) {
+                callback(contact);
+            }
+        }
+    }
+
+    int GetSize() const {
+        return static_cast<int>(contacts.size());
+    }
+};
+
+#endif //CONTACT_CACHE_H
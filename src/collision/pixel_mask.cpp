@@ -0,0 +1,154 @@
+#include "pixel_mask.h"
+
+#include <algorithm>
+#include <cmath>
+
+PixelMask::PixelMask(const int width, const int height) : width(std::max(0, width)), height(std::max(0, height)),
+                                                          wordsPerRow((std::max(0, width) + 63) / 64) {
+    bits.assign(static_cast<size_t>(wordsPerRow) * this->height, 0);
+}
+
+void PixelMask::Set(const int x, const int y) {
+    if (x >= 0 && x < width && y >= 0 && y < height) {
+        bits[static_cast<size_t>(y) * wordsPerRow + x / 64] |= 1ULL << (x % 64);
+    }
+}
+
+bool PixelMask::IsSet(const int x, const int y) const {
+    if (x < 0 || x >= width || y < 0 || y >= height) {
+        return false;
+    }
+    return bits[static_cast<size_t>(y) * wordsPerRow + x / 64] >> (x % 64) & 1;
+}
+
+uint64_t PixelMask::GetBits(const int x, const int y) const {
+    if (y < 0 || y >= height || x >= width || x <= -64) {
+        return 0;
+    }
+    if (x < 0) {
+        return GetBits(0, y) << -x;
+    }
+    // bits past the width are never set, so the last word needs no masking
+    const uint64_t* row = &bits[static_cast<size_t>(y) * wordsPerRow];
+    const int word = x / 64;
+    const int shift = x % 64;
+    uint64_t result = row[word] >> shift;
+    if (shift != 0 && word + 1 < wordsPerRow) {
+        result |= row[word + 1] << (64 - shift);
+    }
+    return result;
+}
+
+bool PixelMask::Any(int x0, int y0, int x1, int y1) const {
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, width);
+    y1 = std::min(y1, height);
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x += 64) {
+            uint64_t row = GetBits(x, y);
+            if (x1 - x < 64) {
+                row &= (1ULL << (x1 - x)) - 1;
+            }
+            if (row) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+PixelMask PixelMask::Cropped(const int x, const int y, const int width, const int height) const {
+    PixelMask result(width, height);
+    for (int row = 0; row < height; row++) {
+        for (int column = 0; column < width; column++) {
+            if (IsSet(x + column, y + row)) {
+                result.Set(column, row);
+            }
+        }
+    }
+    return result;
+}
+
+PixelMask PixelMask::Flipped(const bool horizontal, const bool vertical) const {
+    PixelMask result(width, height);
+    for (int row = 0; row < height; row++) {
+        for (int column = 0; column < width; column++) {
+            if (IsSet(column, row)) {
+                result.Set(horizontal ? width - 1 - column : column, vertical ? height - 1 - row : row);
+            }
+        }
+    }
+    return result;
+}
+
+bool PixelMask::Overlaps(const PixelMask& a, const int ax, const int ay, const PixelMask& b, const int bx,
+                         const int by) {
+    // work in a's pixels, b starts at (dx, dy)
+    const int dx = bx - ax;
+    const int dy = by - ay;
+    const int x0 = std::max(0, dx);
+    const int y0 = std::max(0, dy);
+    const int x1 = std::min(a.width, dx + b.width);
+    const int y1 = std::min(a.height, dy + b.height);
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x += 64) {
+            // b's pixels past x1 read as clear, no need to mask
+            if (a.GetBits(x, y) & b.GetBits(x - dx, y - dy)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+const PixelMask* SpriteMasks::Get(const int sourceX, const int sourceY, const int flip) const {
+    if (frames.empty()) {
+        return nullptr;
+    }
+    const int column = std::clamp(sourceX / std::max(1, frameWidth), 0, columns - 1);
+    const int row = std::clamp(sourceY / std::max(1, frameHeight), 0, rows - 1);
+    return &frames[(row * columns + column) * 4 + (flip & 3)];
+}
+
+bool PlacedMask::Overlaps(const PlacedMask& a, const PlacedMask& b) {
+    if (a.scaleX == b.scaleX && a.scaleY == b.scaleY) {
+        // same scale, compare them in mask pixels with the word by word test
+        return PixelMask::Overlaps(
+            *a.mask, 0, 0,
+            *b.mask,
+            static_cast<int>(std::lround((b.x - a.x) / a.scaleX)),
+            static_cast<int>(std::lround((b.y - a.y) / a.scaleY))
+        );
+    }
+    // different scales, every set pixel of a in the overlapping area is
+    // checked against the pixels of b it covers. Slower, but rare: sprites of
+    // a level usually share a scale.
+    const double minX = std::max(a.x, b.x);
+    const double minY = std::max(a.y, b.y);
+    const double maxX = std::min(a.x + a.mask->GetWidth() * a.scaleX, b.x + b.mask->GetWidth() * b.scaleX);
+    const double maxY = std::min(a.y + a.mask->GetHeight() * a.scaleY, b.y + b.mask->GetHeight() * b.scaleY);
+    const int x0 = static_cast<int>(std::floor((minX - a.x) / a.scaleX));
+    const int y0 = static_cast<int>(std::floor((minY - a.y) / a.scaleY));
+    const int x1 = static_cast<int>(std::ceil((maxX - a.x) / a.scaleX));
+    const int y1 = static_cast<int>(std::ceil((maxY - a.y) / a.scaleY));
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            if (a.mask->IsSet(x, y) &&
+                Overlaps(b, AABB{a.x + x * a.scaleX, a.y + y * a.scaleY,
+                                 a.x + (x + 1) * a.scaleX, a.y + (y + 1) * a.scaleY})) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool PlacedMask::Overlaps(const PlacedMask& a, const AABB& box) {
+    return a.mask->Any(
+        static_cast<int>(std::floor((box.minX - a.x) / a.scaleX)),
+        static_cast<int>(std::floor((box.minY - a.y) / a.scaleY)),
+        static_cast<int>(std::ceil((box.maxX - a.x) / a.scaleX)),
+        static_cast<int>(std::ceil((box.maxY - a.y) / a.scaleY))
+    );
+}
@@ -0,0 +1,77 @@
+#ifndef PIXEL_MASK_H
+#define PIXEL_MASK_H
+
+#include <cstdint>
+#include <vector>
+
+#include "aabb.h"
+
+// One bit per pixel, set where the sprite is opaque, 64 pixels of a row per
+// word (bit 0 = leftmost). Two masks are compared a row at a time with one
+// AND per 64 pixels, so a 32x32 sprite costs about as much as 32 AABB tests.
+class PixelMask {
+private:
+    int width = 0;
+    int height = 0;
+    int wordsPerRow = 0;
+    std::vector<uint64_t> bits;
+
+public:
+    PixelMask() = default;
+    PixelMask(int width, int height);
+
+    int GetWidth() const {
+        return width;
+    }
+
+    int GetHeight() const {
+        return height;
+    }
+
+    void Set(int x, int y);
+    bool IsSet(int x, int y) const;
+
+    // the 64 pixels of row y starting at column x, bit 0 = column x. Pixels
+    // off the mask read as clear.
+    uint64_t GetBits(int x, int y) const;
+
+    // whether any pixel of the rectangle [x0, x1) x [y0, y1) is set
+    bool Any(int x0, int y0, int x1, int y1) const;
+
+    // the mask of a part of this one, e.g. a spritesheet frame
+    PixelMask Cropped(int x, int y, int width, int height) const;
+    PixelMask Flipped(bool horizontal, bool vertical) const;
+
+    // whether a set pixel of a, with its top left corner at (ax, ay), lands
+    // on a set pixel of b at (bx, by)
+    static bool Overlaps(const PixelMask& a, int ax, int ay, const PixelMask& b, int bx, int by);
+};
+
+// the masks of every frame of a spritesheet cut into frameWidth x frameHeight
+// frames, in the four flips a sprite can be drawn with
+struct SpriteMasks {
+    int frameWidth = 0;
+    int frameHeight = 0;
+    int columns = 0;
+    int rows = 0;
+    // index = (row * columns + column) * 4 + flip, flip as SDL_RendererFlip bits
+    std::vector<PixelMask> frames;
+
+    // the frame whose source rectangle starts at (sourceX, sourceY)
+    const PixelMask* Get(int sourceX, int sourceY, int flip) const;
+};
+
+// a mask drawn in the world, where a sprite is rendered
+struct PlacedMask {
+    const PixelMask* mask = nullptr;
+    double x = 0;
+    double y = 0;
+    double scaleX = 1;
+    double scaleY = 1;
+
+    static bool Overlaps(const PlacedMask& a, const PlacedMask& b);
+    // whether a set pixel lies inside the box
+    static bool Overlaps(const PlacedMask& a, const AABB& box);
+};
+
+#endif //PIXEL_MASK_H
@@ -0,0 +1,109 @@
+#include "spatial_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+// Nearest starts looking this far away and doubles the distance until it has
+// enough colliders, about the size of the grids' cells
+constexpr double NEAREST_START_RADIUS = 64;
+
+void SpatialIndex::SetDynamicColliders(const UniformGrid& grid, const std::vector<AABB>& bounds,
+                                       const std::vector<Entity>& entities) {
+    layers[0] = {&grid, &bounds, &entities};
+}
+
+void SpatialIndex::SetStaticColliders(const UniformGrid& grid, const std::vector<AABB>& bounds,
+                                      const std::vector<Entity>& entities) {
+    layers[1] = {&grid, &bounds, &entities};
+}
+
+void SpatialIndex::QueryAABB(const AABB& box, const uint32_t layerMask, std::vector<Entity>& result) const {
+    ForEachOverlapping(box, layerMask, [&result](const Entity entity, const AABB&) {
+        result.push_back(entity);
+    });
+}
+
+void SpatialIndex::QueryRadius(const double x, const double y, const double radius, const uint32_t layerMask,
+                               std::vector<Entity>& result) const {
+    const AABB box{x - radius, y - radius, x + radius, y + radius};
+    ForEachOverlapping(box, layerMask, [&](const Entity entity, const AABB& bounds) {
+        if (AABB::DistanceSquared(bounds, x, y) < radius * radius) {
+            result.push_back(entity);
+        }
+    });
+}
+
+bool SpatialIndex::Raycast(const double x, const double y, const double directionX, const double directionY,
+                           const double maxDistance, const uint32_t layerMask, RaycastHit& hit) const {
+    const LayerFilter filter{ALL_COLLISION_LAYERS, layerMask};
+    bool isHit = false;
+    for (const auto& layer: layers) {
+        if (!layer.grid) {
+            continue;
+        }
+        double distance;
+        const int index = layer.grid->Raycast(x, y, directionX, directionY, maxDistance, filter, [&](const int i) {
+            double tMin = 0;
+            double tMax = maxDistance;
+            return AABB::ClipRay((*layer.bounds)[i], x, y, directionX, directionY, tMin, tMax) ? tMin : -1.0;
+        }, distance);
+        if (index != -1 && (!isHit || distance < hit.distance)) {
+            hit.entity = (*layer.entities)[index];
+            hit.distance = distance;
+            isHit = true;
+        }
+    }
+    if (isHit) {
+        hit.x = x + directionX * hit.distance;
+        hit.y = y + directionY * hit.distance;
+    }
+    return isHit;
+}
+
+void SpatialIndex::Nearest(const double x, const double y, const int k, const uint32_t layerMask,
+                           std::vector<Entity>& result) const {
+    if (k <= 0) {
+        return;
+    }
+    // everything a search box has to cover before giving up on finding k
+    bool isEmpty = true;
+    AABB area{};
+    for (const auto& layer: layers) {
+        if (layer.grid && layer.grid->GetSize() > 0) {
+            area = isEmpty ? layer.grid->GetArea() : AABB::Union(area, layer.grid->GetArea());
+            isEmpty = false;
+        }
+    }
+    if (isEmpty) {
+        return;
+    }
+
+    // only colliders within radius are certain to be closer than any outside,
+    // so grow the radius until k of them are that close
+    std::vector<std::pair<double, Entity>> found;
+    for (double radius = NEAREST_START_RADIUS;; radius *= 2) {
+        found.clear();
+        const AABB box{x - radius, y - radius, x + radius, y + radius};
+        // once the box covers everything there is nothing left outside it
+        const bool coversArea = box.minX <= area.minX && box.minY <= area.minY &&
+                                box.maxX >= area.maxX && box.maxY >= area.maxY;
+        ForEachOverlapping(box, layerMask, [&](const Entity entity, const AABB& bounds) {
+            const double distanceSquared = AABB::DistanceSquared(bounds, x, y);
+            if (distanceSquared <= radius * radius || coversArea) {
+                found.emplace_back(distanceSquared, entity);
+            }
+        });
+        if (static_cast<int>(found.size()) >= k || coversArea) {
+            break;
+        }
+    }
+
+    const auto count = std::min(static_cast<size_t>(k), found.size());
+    std::partial_sort(found.begin(), found.begin() + count, found.end(), [](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first < b.first : a.second.GetID() < b.second.GetID();
+    });
+    for (size_t i = 0; i < count; i++) {
+        result.push_back(found[i].second);
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include <cstdint>
+#include <vector>
+
+#include "../ecs/ecs.h"
+#include "aabb.h"
+#include "uniform_grid.h"
+
+struct RaycastHit {
+    Entity entity = Entity(-1);
+    // along the normalized direction, 0 when the ray starts inside the box
+    double distance = 0;
+    double x = 0;
+    double y = 0;
+};
+
+// Spatial queries over the colliders, answered from the broadphase grids of
+// the collision systems instead of scanning every entity. It only holds
+// references: the BoxColliderSystem points it at its own grid and at the
+// StaticColliderSystem's every frame, so results reflect the positions of the
+// last collision pass. Results come in a fixed order (moving colliders, then
+// static ones), the same query over the same scene gives the same list.
+//
+// layerMask selects the collision layers to look at, see BoxColliderComponent.
+class SpatialIndex {
+private:
+    // one per grid, bounds and entities are indexed like the grid's boxes.
+    // The moving colliders' grid holds their swept boxes, bounds are the
+    // current ones, hits are always tested against bounds.
+    struct Layer {
+        const UniformGrid* grid = nullptr;
+        const std::vector<AABB>* bounds = nullptr;
+        const std::vector<Entity>* entities = nullptr;
+    };
+
+    Layer layers[2];
+
+    // calls callback(entity, box) once per collider overlapping box
+    template<typename TCallback>
+    void ForEachOverlapping(const AABB& box, const uint32_t layerMask, TCallback&& callback) const {
+        const LayerFilter filter{ALL_COLLISION_LAYERS, layerMask};
+        for (const auto& layer: layers) {
+            if (!layer.grid) {
+                continue;
+            }
+            layer.grid->Query(box, filter, [&](const int index) {
+                const AABB& bounds = (*layer.bounds)[index];
+                if (AABB::Overlaps(box, bounds)) {
+                    callback((*layer.entities)[index], bounds);
+                }
+            });
+        }
+    }
+
+public:
+    void SetDynamicColliders(const UniformGrid& grid, const std::vector<AABB>& bounds,
+                             const std::vector<Entity>& entities);
+    void SetStaticColliders(const UniformGrid& grid, const std::vector<AABB>& bounds,
+                            const std::vector<Entity>& entities);
+
+    // colliders overlapping the box
+    void QueryAABB(const AABB& box, uint32_t layerMask, std::vector<Entity>& result) const;
+    // colliders closer than radius to the point
+    void QueryRadius(double x, double y, double radius, uint32_t layerMask, std::vector<Entity>& result) const;
+    // first collider along the ray, direction must be normalized
+    bool Raycast(double x, double y, double directionX, double directionY, double maxDistance, uint32_t layerMask,
+                 RaycastHit& hit) const;
+    // the k colliders closest to the point, closest first, ties by entity id
+    void Nearest(double x, double y, int k, uint32_t layerMask, std::vector<Entity>& result) const;
+};
+
+#endif //SPATIAL_INDEX_H
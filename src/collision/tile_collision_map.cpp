@@ -0,0 +1,145 @@
+#include "tile_collision_map.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+int TileCollisionMap::ColumnAt(const double x) const {
+    return static_cast<int>(std::floor(x / tileSize));
+}
+
+int TileCollisionMap::RowAt(const double y) const {
+    return static_cast<int>(std::floor(y / tileSize));
+}
+
+void TileCollisionMap::Reset(const int columns, const int rows, const double tileSize) {
+    this->columns = std::max(0, columns);
+    this->rows = std::max(0, rows);
+    this->tileSize = tileSize > 0 ? tileSize : 1;
+    wordsPerRow = (this->columns + 63) / 64;
+    solidBits.assign(static_cast<size_t>(wordsPerRow) * this->rows, 0);
+    solidCount = 0;
+}
+
+void TileCollisionMap::SetSolid(const int column, const int row, const bool isSolid) {
+    if (column < 0 || column >= columns || row < 0 || row >= rows) {
+        return;
+    }
+    uint64_t& word = solidBits[static_cast<size_t>(row) * wordsPerRow + column / 64];
+    const uint64_t bit = 1ULL << (column % 64);
+    if (((word & bit) != 0) != isSolid) {
+        word ^= bit;
+        solidCount += isSolid ? 1 : -1;
+    }
+}
+
+bool TileCollisionMap::IsSolid(const int column, const int row) const {
+    if (column < 0 || column >= columns || row < 0 || row >= rows) {
+        return false;
+    }
+    return solidBits[static_cast<size_t>(row) * wordsPerRow + column / 64] >> (column % 64) & 1;
+}
+
+bool TileCollisionMap::IsSolidAt(const double x, const double y) const {
+    return IsSolid(ColumnAt(x), RowAt(y));
+}
+
+AABB TileCollisionMap::GetTileBounds(const int column, const int row) const {
+    return {column * tileSize, row * tileSize, (column + 1) * tileSize, (row + 1) * tileSize};
+}
+
+bool TileCollisionMap::GetTileRange(const AABB& box, int& column0, int& row0, int& column1, int& row1) const {
+    // boxes only touching a tile's border do not overlap it, same as AABB::Overlaps
+    column0 = std::max(0, ColumnAt(box.minX));
+    row0 = std::max(0, RowAt(box.minY));
+    column1 = std::min(columns - 1, static_cast<int>(std::ceil(box.maxX / tileSize)) - 1);
+    row1 = std::min(rows - 1, static_cast<int>(std::ceil(box.maxY / tileSize)) - 1);
+    return column0 <= column1 && row0 <= row1;
+}
+
+bool TileCollisionMap::FindOverlap(const AABB& box, int& column, int& row) const {
+    int column0, row0, column1, row1;
+    if (solidCount == 0 || !GetTileRange(box, column0, row0, column1, row1)) {
+        return false;
+    }
+    for (int r = row0; r <= row1; r++) {
+        bool isFound = false;
+        ForEachSolidInRow(r, column0, column1, [&](const int c) {
+            column = c;
+            row = r;
+            isFound = true;
+            return false;
+        });
+        if (isFound) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TileCollisionMap::Sweep(const AABB& start, const double dx, const double dy, double& timeOfImpact, int& column,
+                             int& row) const {
+    int column0, row0, column1, row1;
+    if (solidCount == 0 || !GetTileRange(AABB::Union(start, start.Translated(dx, dy)), column0, row0, column1, row1)) {
+        return false;
+    }
+    bool isHit = false;
+    timeOfImpact = std::numeric_limits<double>::infinity();
+    for (int r = row0; r <= row1; r++) {
+        ForEachSolidInRow(r, column0, column1, [&](const int c) {
+            double t;
+            if (AABB::Sweep(start, dx, dy, GetTileBounds(c, r), 0, 0, t) && t < timeOfImpact) {
+                timeOfImpact = t;
+                column = c;
+                row = r;
+                isHit = true;
+            }
+            return true;
+        });
+    }
+    return isHit;
+}
+
+bool TileCollisionMap::Raycast(const double x, const double y, const double directionX, const double directionY,
+                               const double maxDistance, double& distance, int& column, int& row) const {
+    double tMin = 0;
+    double tMax = maxDistance;
+    const AABB area{0, 0, columns * tileSize, rows * tileSize};
+    if (solidCount == 0 || !AABB::ClipRay(area, x, y, directionX, directionY, tMin, tMax)) {
+        return false;
+    }
+
+    // Amanatides & Woo, the t of the next vertical and horizontal tile border
+    constexpr double infinity = std::numeric_limits<double>::infinity();
+    int c = std::clamp(ColumnAt(x + directionX * tMin), 0, columns - 1);
+    int r = std::clamp(RowAt(y + directionY * tMin), 0, rows - 1);
+    const int stepColumn = directionX > 0 ? 1 : -1;
+    const int stepRow = directionY > 0 ? 1 : -1;
+    double nextColumnT = directionX == 0 ? infinity : ((c + (directionX > 0)) * tileSize - x) / directionX;
+    double nextRowT = directionY == 0 ? infinity : ((r + (directionY > 0)) * tileSize - y) / directionY;
+    const double columnDeltaT = directionX == 0 ? infinity : tileSize / std::abs(directionX);
+    const double rowDeltaT = directionY == 0 ? infinity : tileSize / std::abs(directionY);
+
+    double enterT = tMin;
+    while (enterT <= tMax) {
+        if (IsSolid(c, r)) {
+            distance = enterT;
+            column = c;
+            row = r;
+            return true;
+        }
+        if (nextColumnT < nextRowT) {
+            enterT = nextColumnT;
+            c += stepColumn;
+            nextColumnT += columnDeltaT;
+        } else {
+            enterT = nextRowT;
+            r += stepRow;
+            nextRowT += rowDeltaT;
+        }
+        if (c < 0 || c >= columns || r < 0 || r >= rows) {
+            return false;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,91 @@
+#ifndef TILE_COLLISION_MAP_H
+#define TILE_COLLISION_MAP_H
+
+#include <cstdint>
+#include <vector>
+
+#include "aabb.h"
+#include "collision_layers.h"
+
+// Solid terrain tiles as a packed bit grid, one bit per tile, 64 tiles of a
+// row per word. Built once when the level loads, so terrain needs no collider
+// entities: checking a box touches only the tiles under it, a row of them a
+// word at a time. The map starts at the world origin, like the tile entities.
+class TileCollisionMap {
+private:
+    int columns = 0;
+    int rows = 0;
+    // in world units, tile size times map scale
+    double tileSize = 1;
+    int wordsPerRow = 0;
+    // bit column % 64 of word row * wordsPerRow + column / 64
+    std::vector<uint64_t> solidBits;
+    int solidCount = 0;
+    LayerFilter filter{1u << COLLISION_LAYER_TERRAIN, ALL_COLLISION_LAYERS};
+
+    int ColumnAt(double x) const;
+    int RowAt(double y) const;
+
+    // calls callback(column) for the solid tiles of row between the two
+    // columns (inclusive, already clamped) until it returns false
+    template<typename TCallback>
+    bool ForEachSolidInRow(const int row, const int column0, const int column1, TCallback&& callback) const {
+        const uint64_t* words = &solidBits[static_cast<size_t>(row) * wordsPerRow];
+        for (int word = column0 / 64; word <= column1 / 64; word++) {
+            uint64_t bits = words[word];
+            if (word == column0 / 64) {
+                bits &= ~0ULL << (column0 % 64);
+            }
+            if (word == column1 / 64 && column1 % 64 != 63) {
+                bits &= (1ULL << (column1 % 64 + 1)) - 1;
+            }
+            while (bits) {
+                if (!callback(word * 64 + __builtin_ctzll(bits))) {
+                    return false;
+                }
+                bits &= bits - 1;
+            }
+        }
+        return true;
+    }
+
+    // the tiles a box strictly overlaps, false when it is off the map
+    bool GetTileRange(const AABB& box, int& column0, int& row0, int& column1, int& row1) const;
+
+public:
+    // drops every solid tile and resizes the map
+    void Reset(int columns, int rows, double tileSize);
+
+    void SetSolid(int column, int row, bool isSolid);
+    // tiles off the map are not solid
+    bool IsSolid(int column, int row) const;
+    bool IsSolidAt(double x, double y) const;
+
+    bool HasSolidTiles() const {
+        return solidCount > 0;
+    }
+
+    double GetTileSize() const {
+        return tileSize;
+    }
+
+    AABB GetTileBounds(int column, int row) const;
+
+    // terrain sits on COLLISION_LAYER_TERRAIN, colliders whose mask leaves
+    // that layer out go through it
+    const LayerFilter& GetFilter() const {
+        return filter;
+    }
+
+    // the first solid tile (row by row) the box overlaps
+    bool FindOverlap(const AABB& box, int& column, int& row) const;
+    // the first solid tile the box hits moving by (dx, dy) from start, and
+    // the fraction of the move at which it does, see AABB::Sweep
+    bool Sweep(const AABB& start, double dx, double dy, double& timeOfImpact, int& column, int& row) const;
+    // the first solid tile along the ray, walked tile by tile (DDA).
+    // direction must be normalized, distance is 0 when starting in a solid tile
+    bool Raycast(double x, double y, double directionX, double directionY, double maxDistance,
+                 double& distance, int& column, int& row) const;
+};
+
+#endif //TILE_COLLISION_MAP_H
@@ -0,0 +1,131 @@
+#include "uniform_grid.h"
+#include <algorithm>
+#include <cmath>
+
+// upper bound for the number of cells relative to the number of boxes, keeps a
+// single far away box from blowing up the grid
+constexpr long long MAX_CELLS_PER_BOX = 4;
+constexpr long long MIN_CELLS = 1024;
+
+UniformGrid::UniformGrid(const double cellSize) : cellSize(cellSize) {
+}
+
+int UniformGrid::ToColumn(const double x) const {
+    return std::clamp(static_cast<int>(std::floor((x - originX) / buildCellSize)), 0, columns - 1);
+}
+
+int UniformGrid::ToRow(const double y) const {
+    return std::clamp(static_cast<int>(std::floor((y - originY) / buildCellSize)), 0, rows - 1);
+}
+
+void UniformGrid::Build(const std::vector<AABB>& boxes) {
+    filters.assign(boxes.size(), LayerFilter());
+    Build(boxes, filters);
+}
+
+void UniformGrid::Build(const std::vector<AABB>& boxes, const std::vector<LayerFilter>& boxFilters) {
+    if (&boxFilters != &filters) {
+        filters.assign(boxFilters.begin(), boxFilters.end());
+    }
+    bounds.assign(boxes.begin(), boxes.end());
+    if (bounds.empty()) {
+        columns = rows = 0;
+        cellStart.assign(1, 0);
+        cellItems.clear();
+        return;
+    }
+
+    double minX = bounds[0].minX;
+    double minY = bounds[0].minY;
+    double maxX = bounds[0].maxX;
+    double maxY = bounds[0].maxY;
+    for (const auto& box: bounds) {
+        minX = std::min(minX, box.minX);
+        minY = std::min(minY, box.minY);
+        maxX = std::max(maxX, box.maxX);
+        maxY = std::max(maxY, box.maxY);
+    }
+    originX = minX;
+    originY = minY;
+
+    const long long maxCells = std::max(MIN_CELLS, MAX_CELLS_PER_BOX * static_cast<long long>(bounds.size()));
+    buildCellSize = cellSize;
+    while (true) {
+        const auto width = static_cast<long long>((maxX - minX) / buildCellSize) + 1;
+        const auto height = static_cast<long long>((maxY - minY) / buildCellSize) + 1;
+        if (width * height <= maxCells) {
+            columns = static_cast<int>(width);
+            rows = static_cast<int>(height);
+            break;
+        }
+        buildCellSize *= 2;
+    }
+
+    cellRanges.resize(bounds.size());
+    for (size_t index = 0; index < bounds.size(); index++) {
+        const auto& box = bounds[index];
+        cellRanges[index] = {ToColumn(box.minX), ToRow(box.minY), ToColumn(box.maxX), ToRow(box.maxY)};
+    }
+
+    // count the boxes per cell, prefix sum into start offsets, then scatter
+    const int cellCount = columns * rows;
+    cellStart.assign(cellCount + 1, 0);
+    for (const auto& range: cellRanges) {
+        for (int row = range.row0; row <= range.row1; row++) {
+            for (int column = range.column0; column <= range.column1; column++) {
+                cellStart[row * columns + column + 1]++;
+            }
+        }
+    }
+    for (int cell = 0; cell < cellCount; cell++) {
+        cellStart[cell + 1] += cellStart[cell];
+    }
+    cellItems.resize(cellStart[cellCount]);
+
+    // cellStart[c] is used as the write cursor of cell c and ends up as the
+    // start of cell c + 1, shifting it back afterwards restores the offsets
+    for (int index = 0; index < static_cast<int>(cellRanges.size()); index++) {
+        const auto& range = cellRanges[index];
+        for (int row = range.row0; row <= range.row1; row++) {
+            for (int column = range.column0; column <= range.column1; column++) {
+                cellItems[cellStart[row * columns + column]++] = index;
+            }
+        }
+    }
+    for (int cell = cellCount; cell > 0; cell--) {
+        cellStart[cell] = cellStart[cell - 1];
+    }
+    cellStart[0] = 0;
+}
+
+void UniformGrid::FindPairs(std::vector<std::pair<int, int>>& pairs) const {
+    FindPairs(0, GetSize(), pairs);
+}
+
+void UniformGrid::FindPairs(const int first, const int last, std::vector<std::pair<int, int>>& pairs) const {
+    for (int i = first; i < last; i++) {
+        const auto& a = cellRanges[i];
+        const auto& aFilter = filters[i];
+        const size_t firstPairOfBox = pairs.size();
+        for (int row = a.row0; row <= a.row1; row++) {
+            for (int column = a.column0; column <= a.column1; column++) {
+                const int cell = row * columns + column;
+                const auto end = cellItems.begin() + cellStart[cell + 1];
+                // cells hold their boxes in index order, skip straight past i
+                for (auto item = std::upper_bound(cellItems.begin() + cellStart[cell], end, i); item != end; ++item) {
+                    const auto& b = cellRanges[*item];
+                    // the corner of the intersection lies in the cell covered
+                    // by both ranges' maximum start, only that cell reports the pair
+                    if (std::max(a.column0, b.column0) == column && std::max(a.row0, b.row0) == row &&
+                        LayerFilter::Accepts(aFilter, filters[*item])) {
+                        pairs.emplace_back(i, *item);
+                    }
+                }
+            }
+        }
+        // a box covering several cells finds its partners out of order
+        if (a.column0 != a.column1 || a.row0 != a.row1) {
+            std::sort(pairs.begin() + firstPairOfBox, pairs.end());
+        }
+    }
+}
@@ -0,0 +1,175 @@
+#ifndef UNIFORM_GRID_H
+#define UNIFORM_GRID_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "aabb.h"
+#include "collision_layers.h"
+
+// Uniform grid broadphase. Build buckets the boxes into square cells with a
+// counting sort (two flat arrays, no per-cell containers), sized to the boxes'
+// combined bounds. The buffers are kept between builds, so rebuilding every
+// frame does not allocate once the world stopped growing.
+class UniformGrid {
+private:
+    double cellSize;
+    // cell size used by the last build, grows when the bounds would need too many cells
+    double buildCellSize = 0;
+    double originX = 0;
+    double originY = 0;
+    int columns = 0;
+    int rows = 0;
+
+    // the cells covered by a box, inclusive
+    struct CellRange {
+        int column0;
+        int row0;
+        int column1;
+        int row1;
+    };
+
+    // boxes of cell c are cellItems[cellStart[c] .. cellStart[c + 1]), in index order
+    std::vector<int> cellStart;
+    std::vector<int> cellItems;
+    std::vector<AABB> bounds;
+    std::vector<LayerFilter> filters;
+    std::vector<CellRange> cellRanges;
+
+    int ToColumn(double x) const;
+    int ToRow(double y) const;
+
+public:
+    explicit UniformGrid(double cellSize = 64);
+
+    // every box pairs with every other one
+    void Build(const std::vector<AABB>& boxes);
+    // index = box, pairs whose layer filters reject each other are never reported
+    void Build(const std::vector<AABB>& boxes, const std::vector<LayerFilter>& boxFilters);
+
+    // appends the pairs (i, j), i < j, of boxes sharing at least one cell and
+    // accepting each other's layers, sorted by i then j. A pair sharing several cells is only reported by the
+    // cell holding the top left corner of the boxes' intersection, so there
+    // are no duplicates.
+    void FindPairs(std::vector<std::pair<int, int>>& pairs) const;
+    // the same for the pairs whose i is in [first, last), so disjoint ranges
+    // can be searched on different threads
+    void FindPairs(int first, int last, std::vector<std::pair<int, int>>& pairs) const;
+
+    int GetSize() const {
+        return static_cast<int>(bounds.size());
+    }
+
+    const AABB& GetBounds(const int index) const {
+        return bounds[index];
+    }
+
+    // the area covered by the cells, every box of the last build lies inside
+    AABB GetArea() const {
+        return {originX, originY, originX + columns * buildCellSize, originY + rows * buildCellSize};
+    }
+
+    template<typename TCallback>
+    void Query(const AABB& box, TCallback&& callback) const {
+        Query(box, LayerFilter(), std::forward<TCallback>(callback));
+    }
+
+    // calls callback(index) once for every box overlapping the given one and
+    // accepting its layer filter
+    template<typename TCallback>
+    void Query(const AABB& box, const LayerFilter& filter, TCallback&& callback) const {
+        if (bounds.empty()) {
+            return;
+        }
+        const CellRange range = {ToColumn(box.minX), ToRow(box.minY), ToColumn(box.maxX), ToRow(box.maxY)};
+        for (int row = range.row0; row <= range.row1; row++) {
+            for (int column = range.column0; column <= range.column1; column++) {
+                const int cell = row * columns + column;
+                for (int item = cellStart[cell]; item < cellStart[cell + 1]; item++) {
+                    const int index = cellItems[item];
+                    const auto& other = cellRanges[index];
+                    // same rule as FindPairs, a box spanning several cells is reported once
+                    if (std::max(range.column0, other.column0) != column || std::max(range.row0, other.row0) != row) {
+                        continue;
+                    }
+                    if (LayerFilter::Accepts(filter, filters[index]) && AABB::Overlaps(box, bounds[index])) {
+                        callback(index);
+                    }
+                }
+            }
+        }
+    }
+
+    // Walks the cells crossed by the ray (x, y) + direction * t, 0 <= t <= maxT,
+    // nearest first, and calls hit(index) for the boxes in them accepting the
+    // filter. hit returns the t at which the ray enters that box, or a negative
+    // value for a miss. Stops once no cell left can hold a closer hit, and
+    // returns the closest box hit (-1 for none) with its t in hitT. A box
+    // covering several cells may be passed to hit more than once.
+    template<typename THit>
+    int Raycast(
+        const double x, const double y, const double directionX, const double directionY, const double maxT,
+        const LayerFilter& filter, THit&& hit, double& hitT
+    ) const {
+        double tMin = 0;
+        double tMax = maxT;
+        if (bounds.empty() || !AABB::ClipRay(GetArea(), x, y, directionX, directionY, tMin, tMax)) {
+            return -1;
+        }
+
+        // Amanatides & Woo: the t of the next vertical and horizontal cell
+        // border, and how much t it takes to cross a whole cell
+        constexpr double infinity = std::numeric_limits<double>::infinity();
+        int column = ToColumn(x + directionX * tMin);
+        int row = ToRow(y + directionY * tMin);
+        const int stepColumn = directionX > 0 ? 1 : -1;
+        const int stepRow = directionY > 0 ? 1 : -1;
+        double nextColumnT = directionX == 0
+            ? infinity
+            : (originX + (column + (directionX > 0)) * buildCellSize - x) / directionX;
+        double nextRowT = directionY == 0
+            ? infinity
+            : (originY + (row + (directionY > 0)) * buildCellSize - y) / directionY;
+        const double columnDeltaT = directionX == 0 ? infinity : buildCellSize / std::abs(directionX);
+        const double rowDeltaT = directionY == 0 ? infinity : buildCellSize / std::abs(directionY);
+
+        int closest = -1;
+        hitT = infinity;
+        while (true) {
+            const int cell = row * columns + column;
+            for (int item = cellStart[cell]; item < cellStart[cell + 1]; item++) {
+                const int index = cellItems[item];
+                if (!LayerFilter::Accepts(filter, filters[index])) {
+                    continue;
+                }
+                const double t = hit(index);
+                if (t >= 0 && t <= maxT && t < hitT) {
+                    closest = index;
+                    hitT = t;
+                }
+            }
+            // a box hit at t is stored in the cell the ray is in at t, so
+            // nothing in the cells ahead can beat a hit before this cell's exit
+            const double cellExitT = std::min(nextColumnT, nextRowT);
+            if (hitT <= cellExitT || cellExitT > tMax) {
+                break;
+            }
+            if (nextColumnT < nextRowT) {
+                column += stepColumn;
+                nextColumnT += columnDeltaT;
+            } else {
+                row += stepRow;
+                nextRowT += rowDeltaT;
+            }
+            if (column < 0 || column >= columns || row < 0 || row >= rows) {
+                break;
+            }
+        }
+        return closest;
+    }
+};
+
+#endif //UNIFORM_GRID_H
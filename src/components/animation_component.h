@@ -5,7 +5,7 @@
 #ifndef INC_2D_SDL_GAME_ENGINE_ANIMATION_COMPONENT_H
 #define INC_2D_SDL_GAME_ENGINE_ANIMATION_COMPONENT_H
 
-#include <SDL2/SDL.h>
+#include "../timing/frame_clock.h"
 
 struct AnimationComponent {
     int numFrames;
@@ -24,7 +24,7 @@ struct AnimationComponent {
             frameRateSpeed(frameRateSpeed),
             shouldLoop(loop),
             startTime(0) {
-        this->startTime = static_cast<int>(SDL_GetTicks());
+        this->startTime = FrameClock::GetMilliseconds();
     }
 };
 
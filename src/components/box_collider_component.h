@@ -4,17 +4,30 @@
 
 #ifndef BOX_COLLIDER_COMPONENT_H
 #define BOX_COLLIDER_COMPONENT_H
+#include <cstdint>
 #include <glm/glm.hpp>
 
+constexpr int MAX_COLLISION_LAYERS = 32;
+constexpr uint32_t ALL_COLLISION_LAYERS = 0xFFFFFFFF;
+// layers assigned by the engine, levels are free to use the others
+constexpr int COLLISION_LAYER_DEFAULT = 0;
+constexpr int COLLISION_LAYER_PROJECTILES = 1;
+// solid tiles of the tilemap, see TileCollisionMap
+constexpr int COLLISION_LAYER_TERRAIN = 2;
 
 struct BoxColliderComponent {
     int width;
     int height;
     glm::vec2 offset;
+    // the collision layer (0 - 31) this collider is on
+    int layer;
+    // bit n set = collides with colliders on layer n
+    uint32_t mask;
 
     explicit BoxColliderComponent(
-        const int width = 0, const int height = 0, const glm::vec2 offset = glm::vec2(0)
-    ) : width(width), height(height), offset(offset) {
+        const int width = 0, const int height = 0, const glm::vec2 offset = glm::vec2(0),
+        const int layer = COLLISION_LAYER_DEFAULT, const uint32_t mask = ALL_COLLISION_LAYERS
+    ) : width(width), height(height), offset(offset), layer(layer), mask(mask) {
     }
 };
 
@@ -0,0 +1,17 @@
+#ifndef COLLISION_MASK_COMPONENT_H
+#define COLLISION_MASK_COMPONENT_H
+
+#include "../collision/pixel_mask.h"
+
+// Pixel perfect collisions: once the box collider overlaps another one, the
+// BoxColliderSystem also checks the opaque pixels of the current sprite frame.
+// Needs a SpriteComponent, rotation is ignored like it is for the box.
+struct CollisionMaskComponent {
+    // owned by the AssetStore
+    const SpriteMasks* masks;
+
+    explicit CollisionMaskComponent(const SpriteMasks* masks = nullptr) : masks(masks) {
+    }
+};
+
+#endif //COLLISION_MASK_COMPONENT_H
@@ -0,0 +1,18 @@
+#ifndef FAST_MOVER_COMPONENT_H
+#define FAST_MOVER_COMPONENT_H
+
+#include <glm/glm.hpp>
+
+// Marks colliders that can move further than their own size in one frame,
+// e.g. projectiles. The BoxColliderSystem sweeps their box from the position
+// of the last check to the current one, so they cannot tunnel through thin
+// colliders when frames are long.
+struct FastMoverComponent {
+    // where the box was when collisions were last checked
+    glm::vec2 previousPosition;
+
+    explicit FastMoverComponent(const glm::vec2 previousPosition = glm::vec2(0)) : previousPosition(previousPosition) {
+    }
+};
+
+#endif //FAST_MOVER_COMPONENT_H
@@ -5,7 +5,7 @@
 #ifndef PROJECTILE_COMPONENT_H
 #define PROJECTILE_COMPONENT_H
 
-#include <SDL2/SDL.h>
+#include "../timing/frame_clock.h"
 
 struct ProjectileComponent {
     bool isFriendly;
@@ -18,7 +18,7 @@ struct ProjectileComponent {
         const int hitPercentDamage = 0,
         const int duration = 0
     ) : isFriendly(isFriendly), hitPercentDamage(hitPercentDamage), duration(duration) {
-        this->startTime = static_cast<int>(SDL_GetTicks());
+        this->startTime = FrameClock::GetMilliseconds();
     }
 };
 
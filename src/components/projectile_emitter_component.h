@@ -5,7 +5,7 @@
 #ifndef PROJECTILE_EMITTER_COMPONENT_H
 #define PROJECTILE_EMITTER_COMPONENT_H
 
-#include <SDL2/SDL.h>
+#include "../timing/frame_clock.h"
 #include <glm/glm.hpp>
 
 struct ProjectileEmitterComponent {
@@ -27,7 +27,7 @@ struct ProjectileEmitterComponent {
         duration(duration),
         hitPercentDamage(hitPercentDamage),
         isFriendly(isFriendly) {
-        this->lastEmissionTime = static_cast<int>(SDL_GetTicks());
+        this->lastEmissionTime = FrameClock::GetMilliseconds();
     }
 };
 
@@ -5,6 +5,8 @@
 
 struct TransformComponent {
     glm::vec2 position;
+    // the position before the last simulation step, see InterpolationSystem
+    glm::vec2 previousPosition;
     glm::vec2 scale;
     double rotation;
 
@@ -14,10 +16,16 @@ struct TransformComponent {
         const double rotation = 0.0f
     ) :
             position(position),
+            previousPosition(position),
             scale(scale),
             rotation(rotation) {
 
     }
+
+    // where to draw the entity, alpha = how far the frame is into the next step
+    glm::vec2 GetInterpolatedPosition(const float alpha) const {
+        return glm::mix(previousPosition, position, alpha);
+    }
 };
 
 #endif // TRANSFORMS_COMPONENT_H
@@ -1,9 +1,101 @@
 #include "ecs.h"
 #include "../logger/logger.h"
+#include "../collision/spatial_index.h"
 #include <algorithm>
+#include <cmath>
 
 // Components
 int BaseComponent::nextID = 0;
+unsigned long long BasePool::nextVersion = 0;
+
+// Labels
+std::unordered_map<std::string, int> EntityLabels::tagBits;
+std::unordered_map<std::string, int> EntityLabels::groupBits;
+int EntityLabels::nextBit = 0;
+
+uint64_t EntityLabels::GetMask(std::unordered_map<std::string, int>& bits, const std::string& name) {
+    const auto label = bits.find(name);
+    if (label != bits.end()) {
+        return 1ull << label->second;
+    }
+    if (nextBit >= 64) {
+        Logger::Err("Out of entity label bits, '" + name + "' will never match a filter");
+        return 0;
+    }
+    bits.emplace(name, nextBit);
+    return 1ull << nextBit++;
+}
+
+uint64_t EntityLabels::GetTagMask(const std::string& tag) {
+    return GetMask(tagBits, tag);
+}
+
+uint64_t EntityLabels::GetGroupMask(const std::string& group) {
+    return GetMask(groupBits, group);
+}
+
+uint64_t MortonCode(const uint32_t x, const uint32_t y) {
+    // spread the bits of a 32 bit value so there is a zero between each of them
+    const auto spread = [](uint64_t v) {
+        v = (v | (v << 16)) & 0x0000FFFF0000FFFFull;
+        v = (v | (v << 8)) & 0x00FF00FF00FF00FFull;
+        v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0Full;
+        v = (v | (v << 2)) & 0x3333333333333333ull;
+        v = (v | (v << 1)) & 0x5555555555555555ull;
+        return v;
+    };
+    return spread(x) | (spread(y) << 1);
+}
+
+// Pools
+bool BasePool::IsReordering() const {
+    return reorderCursor < reorderPlan.size();
+}
+
+bool BasePool::IsOrderDirty() const {
+    return isOrderDirty;
+}
+
+void BasePool::BeginReorder(std::vector<int>& entityOrder) {
+    reorderPlan.swap(entityOrder);
+    reorderCursor = 0;
+    reorderPlaced = 0;
+    hasReorderMoved = false;
+    isOrderDirty = false;
+}
+
+bool BasePool::StepReorder(const int maxSteps) {
+    for (int step = 0; step < maxSteps && reorderCursor < reorderPlan.size(); step++, reorderCursor++) {
+        if (reorderPlaced >= GetSize()) {
+            reorderCursor = reorderPlan.size();
+            break;
+        }
+        // entities that left the pool since the plan was made are skipped
+        const int index = GetIndexOf(reorderPlan[reorderCursor]);
+        if (index == -1) {
+            continue;
+        }
+        if (index != reorderPlaced) {
+            Swap(index, reorderPlaced);
+            hasReorderMoved = true;
+        }
+        reorderPlaced++;
+    }
+    if (reorderCursor < reorderPlan.size()) {
+        return false;
+    }
+    reorderPlan.clear();
+    reorderCursor = 0;
+    return true;
+}
+
+bool BasePool::HasReorderMoved() const {
+    return hasReorderMoved;
+}
+
+unsigned long long BasePool::GetOrderVersion() const {
+    return orderVersion;
+}
 
 // Entity
 Entity::Entity(const int id) : id(id), registry(nullptr) {
@@ -15,6 +107,18 @@ void Entity::Destroy() const {
 
 int Entity::GetID() const { return this->id; }
 
+void Entity::Enable() const {
+    registry->EnableEntity(*this);
+}
+
+void Entity::Disable() const {
+    registry->DisableEntity(*this);
+}
+
+bool Entity::IsEnabled() const {
+    return registry->IsEntityEnabled(*this);
+}
+
 void Entity::Tag(const std::string& tag) const {
     registry->TagEntity(*this, tag);
 }
@@ -31,34 +135,107 @@ bool Entity::BelongsToGroup(const std::string& group) const {
     return registry->EntityBelongsToGroup(*this, group);
 }
 
+uint64_t Entity::GetLabels() const {
+    return registry->GetEntityLabels(*this);
+}
+
 // Systems
-void System::AddEntity(const Entity entity) { this->entities.push_back(entity); }
+void System::AddEntity(const Entity entity) {
+    if (HasEntity(entity)) {
+        return;
+    }
+    if (entity.GetID() >= static_cast<int>(entityIndices.size())) {
+        entityIndices.resize(entity.GetID() + 1, -1);
+    }
+    entityIndices[entity.GetID()] = static_cast<int>(entities.size());
+    this->entities.push_back(entity);
+    entitiesVersion++;
+}
 
-void System::RemoveEntity(Entity entity) {
-    // I hate this, next time use a boring for loop
-    this->entities.erase(
-        std::remove_if(
-            entities.begin(), entities.end(),
-            [&entity](Entity e) {
-                return e == entity;
-            }
-        ),
-        entities.end()
-    );
+void System::RemoveEntity(const Entity entity) {
+    if (!HasEntity(entity)) {
+        return;
+    }
+    // swap the last entity into the removed slot
+    const int indexOfRemoved = entityIndices[entity.GetID()];
+    const Entity lastEntity = entities.back();
+    entities[indexOfRemoved] = lastEntity;
+    entityIndices[lastEntity.GetID()] = indexOfRemoved;
+    entityIndices[entity.GetID()] = -1;
+    entities.pop_back();
+    entitiesVersion++;
+}
+
+bool System::HasEntity(const Entity entity) const {
+    return entity.GetID() < static_cast<int>(entityIndices.size()) && entityIndices[entity.GetID()] != -1;
+}
+
+void System::RebuildEntityIndices() {
+    std::fill(entityIndices.begin(), entityIndices.end(), -1);
+    for (int i = 0; i < static_cast<int>(entities.size()); i++) {
+        const int entityID = entities[i].GetID();
+        if (entityID >= static_cast<int>(entityIndices.size())) {
+            entityIndices.resize(entityID + 1, -1);
+        }
+        entityIndices[entityID] = i;
+    }
 }
 
 std::vector<Entity> System::GetEntities() const { return this->entities; }
 
+const std::vector<Entity>& System::GetEntityList() const { return this->entities; }
+
+unsigned int System::GetEntitiesVersion() const { return this->entitiesVersion; }
+
 const Signature& System::GetComponentSignature() const {
     return this->componentSignature;
 }
 
+const Signature& System::GetExcludedComponentSignature() const {
+    return this->excludedComponentSignature;
+}
+
+bool System::IsInterestedIn(const Entity entity, const Signature& entityComponentSignature) const {
+    if ((entityComponentSignature & componentSignature) != componentSignature) {
+        return false;
+    }
+    if ((entityComponentSignature & excludedComponentSignature).any()) {
+        return false;
+    }
+
+    const auto hasTag = [&entity](const std::string& tag) { return entity.HasTag(tag); };
+    const auto belongsToGroup = [&entity](const std::string& group) { return entity.BelongsToGroup(group); };
+    if (!requiredTags.empty() && std::none_of(requiredTags.begin(), requiredTags.end(), hasTag)) {
+        return false;
+    }
+    if (std::any_of(excludedTags.begin(), excludedTags.end(), hasTag)) {
+        return false;
+    }
+    if (!requiredGroups.empty() && std::none_of(requiredGroups.begin(), requiredGroups.end(), belongsToGroup)) {
+        return false;
+    }
+    if (std::any_of(excludedGroups.begin(), excludedGroups.end(), belongsToGroup)) {
+        return false;
+    }
+    return true;
+}
+
+void System::RequireTag(const std::string& tag) { this->requiredTags.push_back(tag); }
+
+void System::ExcludeTag(const std::string& tag) { this->excludedTags.push_back(tag); }
+
+void System::RequireGroup(const std::string& group) { this->requiredGroups.push_back(group); }
+
+void System::ExcludeGroup(const std::string& group) { this->excludedGroups.push_back(group); }
+
 Entity Registry::CreateEntity() {
     int entityID;
     if (this->freeIDs.empty()) {
         entityID = numEntities++;
         if (entityID >= static_cast<int>(entityComponentSignatures.size())) {
             entityComponentSignatures.resize(entityID + 1);
+            disabledEntities.resize(entityID + 1, false);
+            entityLabels.resize(entityID + 1, 0);
         }
     } else {
         // reuse an id from the list of recently destroyed entities
@@ -83,6 +260,7 @@ void Registry::Update() {
     for (auto& entity: entitiesToDestroy) {
         RemoveEntityFromSystems(entity);
         entityComponentSignatures[entity.GetID()].reset();
+        disabledEntities[entity.GetID()] = false;
 
         // remove the entity from the component pools
         for (const auto& pool: componentPools) {
@@ -98,6 +276,53 @@ void Registry::Update() {
         RemoveEntityGroup(entity);
     }
     entitiesToDestroy.clear();
+
+    UpdatePoolOrdering();
+}
+
+void Registry::UpdatePoolOrdering() {
+    for (auto& [componentID, policy]: poolOrderPolicies) {
+        if (componentID >= static_cast<int>(componentPools.size()) || !componentPools[componentID]) {
+            continue;
+        }
+        const auto& pool = componentPools[componentID];
+        if (!pool->IsReordering()) {
+            const bool hasWatchedChanged = policy.watchedVersion && policy.watchedVersion() != policy.plannedVersion;
+            if (!pool->IsOrderDirty() && !hasWatchedChanged) {
+                continue;
+            }
+            poolOrderScratch.clear();
+            policy.planOrder(poolOrderScratch);
+            pool->BeginReorder(poolOrderScratch);
+        }
+        if (!pool->StepReorder(policy.stepsPerFrame)) {
+            continue;
+        }
+        // taken after the pass, so its own swaps do not trigger the next one
+        if (policy.watchedVersion) {
+            policy.plannedVersion = policy.watchedVersion();
+        }
+        if (pool->HasReorderMoved() && componentID == iterationOrderComponentID) {
+            SortSystemsByPool(componentID);
+        }
+    }
+}
+
+void Registry::SortSystemsByPool(const int componentID) const {
+    const auto& pool = componentPools[componentID];
+    for (const auto& system: systems) {
+        if (!system.second->GetComponentSignature().test(componentID)) {
+            continue;
+        }
+        auto& entities = system.second->entities;
+        std::sort(
+            entities.begin(), entities.end(),
+            [&pool](const Entity a, const Entity b) {
+                return pool->GetIndexOf(a.GetID()) < pool->GetIndexOf(b.GetID());
+            }
+        );
+        system.second->RebuildEntityIndices();
+    }
 }
 
 void Registry::DestroyEntity(const Entity entity) {
@@ -107,26 +332,147 @@ void Registry::DestroyEntity(const Entity entity) {
 void Registry::AddEntityToSystems(const Entity entity) const {
     const auto entityID = entity.GetID();
     const auto& entityComponentSignature = entityComponentSignatures[entityID];
+    if (disabledEntities[entityID]) {
+        return;
+    }
 
     for (auto& system: systems) {
-        const auto& systemComponentSignature = system.second->GetComponentSignature();
-        const bool isInterested = (entityComponentSignature & systemComponentSignature) == systemComponentSignature;
-        if (isInterested) {
+        if (system.second->IsInterestedIn(entity, entityComponentSignature)) {
             system.second->AddEntity(entity);
         }
     }
 }
 
+void Registry::RefreshEntityInSystems(const Entity entity) {
+    // entities waiting to be created get their systems on the next Update
+    if (entitiesToCreate.find(entity) != entitiesToCreate.end()) {
+        return;
+    }
+
+    Entity liveEntity(entity.GetID());
+    liveEntity.registry = this;
+    const auto& entityComponentSignature = entityComponentSignatures[liveEntity.GetID()];
+    const bool isDisabled = disabledEntities[liveEntity.GetID()];
+
+    for (auto& system: systems) {
+        const bool isInterested = !isDisabled && system.second->IsInterestedIn(liveEntity, entityComponentSignature);
+        const bool hasEntity = system.second->HasEntity(liveEntity);
+        if (isInterested && !hasEntity) {
+            system.second->AddEntity(liveEntity);
+        } else if (!isInterested && hasEntity) {
+            system.second->RemoveEntity(liveEntity);
+        }
+    }
+}
+
+void Registry::EnableEntity(const Entity entity) {
+    if (!disabledEntities[entity.GetID()]) {
+        return;
+    }
+    disabledEntities[entity.GetID()] = false;
+    RefreshEntityInSystems(entity);
+}
+
+void Registry::DisableEntity(const Entity entity) {
+    if (disabledEntities[entity.GetID()]) {
+        return;
+    }
+    disabledEntities[entity.GetID()] = true;
+    RemoveEntityFromSystems(entity);
+}
+
+bool Registry::IsEntityEnabled(const Entity entity) const {
+    return !disabledEntities[entity.GetID()];
+}
+
+void Registry::CaptureSnapshot(RegistrySnapshot& snapshot) const {
+    snapshot.numEntities = numEntities;
+
+    snapshot.componentPools.resize(componentPools.size());
+    for (size_t i = 0; i < componentPools.size(); i++) {
+        const auto& pool = componentPools[i];
+        auto& snapshotPool = snapshot.componentPools[i];
+        if (!pool) {
+            snapshotPool = nullptr;
+        } else if (!snapshotPool) {
+            snapshotPool = pool->Clone();
+        } else if (snapshotPool->GetVersion() != pool->GetVersion()) {
+            snapshotPool->CopyFrom(*pool);
+        }
+    }
+
+    for (const auto& system: systems) {
+        snapshot.systemEntities[system.first] = system.second->entities;
+    }
+
+    snapshot.entityComponentSignatures = entityComponentSignatures;
+    snapshot.disabledEntities = disabledEntities;
+    snapshot.entityLabels = entityLabels;
+    snapshot.entitiesToCreate = entitiesToCreate;
+    snapshot.entitiesToDestroy = entitiesToDestroy;
+    snapshot.freeIDs = freeIDs;
+    snapshot.entityPerTag = entityPerTag;
+    snapshot.tagPerEntity = tagPerEntity;
+    snapshot.entitiesPerGroup = entitiesPerGroup;
+    snapshot.groupPerEntity = groupPerEntity;
+}
+
+void Registry::RestoreSnapshot(const RegistrySnapshot& snapshot) {
+    numEntities = snapshot.numEntities;
+
+    // pools are never deleted, so the live registry has at least as many as the snapshot
+    for (size_t i = 0; i < componentPools.size(); i++) {
+        auto& pool = componentPools[i];
+        const auto snapshotPool = i < snapshot.componentPools.size() ? snapshot.componentPools[i] : nullptr;
+        if (!snapshotPool) {
+            if (pool) {
+                pool->Clear();
+            }
+        } else if (!pool) {
+            pool = snapshotPool->Clone();
+        } else if (pool->GetVersion() != snapshotPool->GetVersion()) {
+            pool->CopyFrom(*snapshotPool);
+        }
+    }
+
+    // systems keep their entity list buffers, restoring them is a plain copy
+    for (auto& system: systems) {
+        const auto systemEntities = snapshot.systemEntities.find(system.first);
+        if (systemEntities == snapshot.systemEntities.end()) {
+            system.second->entities.clear();
+        } else {
+            system.second->entities = systemEntities->second;
+        }
+        system.second->RebuildEntityIndices();
+        // components may have changed too, anything cached must be rebuilt
+        system.second->entitiesVersion++;
+    }
+
+    entityComponentSignatures = snapshot.entityComponentSignatures;
+    disabledEntities = snapshot.disabledEntities;
+    entityLabels = snapshot.entityLabels;
+    entitiesToCreate = snapshot.entitiesToCreate;
+    entitiesToDestroy = snapshot.entitiesToDestroy;
+    freeIDs = snapshot.freeIDs;
+    entityPerTag = snapshot.entityPerTag;
+    tagPerEntity = snapshot.tagPerEntity;
+    entitiesPerGroup = snapshot.entitiesPerGroup;
+    groupPerEntity = snapshot.groupPerEntity;
+}
+
 void Registry::TagEntity(Entity entity, const std::string& tag) {
     entityPerTag.emplace(tag, entity);
-    tagPerEntity.emplace(entity.GetID(), tag);
+    const auto taggedEntity = tagPerEntity.emplace(entity.GetID(), tag).first;
+    entityLabels[entity.GetID()] |= EntityLabels::GetTagMask(taggedEntity->second);
+    RefreshEntityInSystems(entity);
 }
 
 bool Registry::EntityHasTag(Entity entity, const std::string& tag) const {
-    if (tagPerEntity.find(entity.GetID()) == tagPerEntity.end()) {
+    const auto taggedEntity = tagPerEntity.find(entity.GetID());
+    if (taggedEntity == tagPerEntity.end()) {
         return false;
     }
-    return entityPerTag.find(tag)->second == entity;
+    return taggedEntity->second == tag;
 }
 
 Entity Registry::GetEntityByTag(const std::string& tag) const {
@@ -139,21 +485,28 @@ void Registry::RemoveEntityTag(Entity entity) {
         const auto tag = taggedEntity->second;
         entityPerTag.erase(tag);
         tagPerEntity.erase(taggedEntity);
+        entityLabels[entity.GetID()] &= ~EntityLabels::GetTagMask(tag);
+        // systems requiring or excluding the tag, unless the entity is on its way out
+        if (entitiesToDestroy.find(entity) == entitiesToDestroy.end()) {
+            RefreshEntityInSystems(entity);
+        }
     }
 }
 
 void Registry::GroupEntity(Entity entity, const std::string& group) {
     entitiesPerGroup.emplace(group, std::set<Entity>());
     entitiesPerGroup[group].emplace(entity);
-    groupPerEntity.emplace(entity.GetID(), group);
+    const auto groupedEntity = groupPerEntity.emplace(entity.GetID(), group).first;
+    entityLabels[entity.GetID()] |= EntityLabels::GetGroupMask(groupedEntity->second);
+    RefreshEntityInSystems(entity);
 }
 
 bool Registry::EntityBelongsToGroup(const Entity entity, const std::string& group) const {
-    if (entitiesPerGroup.find(group) == entitiesPerGroup.end()) {
+    const auto groupedEntity = groupPerEntity.find(entity.GetID());
+    if (groupedEntity == groupPerEntity.end()) {
         return false;
     }
-    auto groupEntities = entitiesPerGroup.at(group);
-    return groupEntities.find(entity.GetID()) != groupEntities.end();
+    return groupedEntity->second == group;
 }
 
 std::vector<Entity> Registry::GetEntitiesByGroup(const std::string& group) const {
@@ -175,8 +528,66 @@ void Registry::RemoveEntityGroup(const Entity entity) {
                 group->second.erase(entityInGroup);
             }
         }
+        entityLabels[entity.GetID()] &= ~EntityLabels::GetGroupMask(groupedEntity->second);
         groupPerEntity.erase(groupedEntity);
+        if (entitiesToDestroy.find(entity) == entitiesToDestroy.end()) {
+            RefreshEntityInSystems(entity);
+        }
+    }
+}
+
+uint64_t Registry::GetEntityLabels(const Entity entity) const {
+    return entityLabels[entity.GetID()];
+}
+
+void Registry::SetSpatialIndex(const SpatialIndex* spatialIndex) {
+    this->spatialIndex = spatialIndex;
+}
+
+std::vector<Entity> Registry::QueryAABB(const double minX, const double minY, const double maxX, const double maxY,
+                                        const uint32_t layerMask) const {
+    std::vector<Entity> result;
+    if (!spatialIndex) {
+        Logger::Err("Spatial query without a spatial index, is the BoxColliderSystem running?");
+        return result;
+    }
+    spatialIndex->QueryAABB({minX, minY, maxX, maxY}, layerMask, result);
+    return result;
+}
+
+std::vector<Entity> Registry::QueryRadius(const double x, const double y, const double radius,
+                                          const uint32_t layerMask) const {
+    std::vector<Entity> result;
+    if (!spatialIndex) {
+        Logger::Err("Spatial query without a spatial index, is the BoxColliderSystem running?");
+        return result;
+    }
+    spatialIndex->QueryRadius(x, y, radius, layerMask, result);
+    return result;
+}
+
+bool Registry::Raycast(const double x, const double y, const double directionX, const double directionY,
+                       const double maxDistance, RaycastHit& hit, const uint32_t layerMask) const {
+    if (!spatialIndex) {
+        Logger::Err("Spatial query without a spatial index, is the BoxColliderSystem running?");
+        return false;
+    }
+    const double length = std::sqrt(directionX * directionX + directionY * directionY);
+    if (length == 0) {
+        Logger::Err("Raycast with a zero direction");
+        return false;
+    }
+    return spatialIndex->Raycast(x, y, directionX / length, directionY / length, maxDistance, layerMask, hit);
+}
+
+std::vector<Entity> Registry::Nearest(const double x, const double y, const int k, const uint32_t layerMask) const {
+    std::vector<Entity> result;
+    if (!spatialIndex) {
+        Logger::Err("Spatial query without a spatial index, is the BoxColliderSystem running?");
+        return result;
     }
+    spatialIndex->Nearest(x, y, k, layerMask, result);
+    return result;
 }
 
 void Registry::RemoveEntityFromSystems(const Entity entity) const {
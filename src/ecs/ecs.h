@@ -1,13 +1,18 @@
 #ifndef ECS_H
 #define ECS_H
 
+#include <algorithm>
 #include <bitset>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <deque>
 #include <vector>
 #include <unordered_map>
 #include <typeindex>
 #include <set>
 #include <memory>
+#include <type_traits>
 #include <SDL2/SDL_hints.h>
 #include <cstdio>
 #include <iostream>
@@ -35,6 +40,23 @@ public:
     }
 };
 
+// assigns each tag and group name its own bit, so filters can test an
+// entity's tag and group with a single AND instead of comparing strings.
+// Like component IDs the bits are global, so they can be computed before any
+// registry exists, e.g. in a system constructor.
+class EntityLabels {
+private:
+    static std::unordered_map<std::string, int> tagBits;
+    static std::unordered_map<std::string, int> groupBits;
+    static int nextBit;
+
+    static uint64_t GetMask(std::unordered_map<std::string, int>& bits, const std::string& name);
+
+public:
+    static uint64_t GetTagMask(const std::string& tag);
+    static uint64_t GetGroupMask(const std::string& group);
+};
+
 class Entity {
 private:
     int id;
@@ -46,10 +68,17 @@ public:
     int GetID() const;
 
     // Manage entity tags and groups
+    // Disabled entities keep their components but are skipped by every system
+    void Enable() const;
+    void Disable() const;
+    bool IsEnabled() const;
+
     void Tag(const std::string& tag) const;
     bool HasTag(const std::string& tag) const;
     void Group(const std::string& group) const;
     bool BelongsToGroup(const std::string& group) const;
+    // the EntityLabels bits of the entity's tag and group
+    uint64_t GetLabels() const;
 
     Entity& operator =(const Entity& other) = default;
     bool operator ==(const Entity& other) const { return this->id == other.id; }
@@ -69,6 +98,9 @@ public:
     template<typename TComponent>
     TComponent& GetComponent() const;
 
+    template<typename TComponent>
+    const TComponent& ReadComponent() const;
+
     // hold a pointer to the entity's owner registry
     // this is a cyclic dependency, but it's ok because this is a demo project.
     // It is important to understand the risks here though
@@ -79,7 +111,26 @@ public:
 class System {
 private:
     Signature componentSignature;
+    // components an entity must NOT have to be processed by the system
+    Signature excludedComponentSignature;
     std::vector<Entity> entities;
+    // sparse array indexed by entity ID, holds the position in entities or -1
+    std::vector<int> entityIndices;
+    // bumped whenever an entity joins or leaves the system (reordering does
+    // not count), lets systems cache data built from their entities
+    unsigned int entitiesVersion = 0;
+
+    // tag and group filters, an entity has at most one tag and one group so
+    // the required lists match if any of their entries match
+    std::vector<std::string> requiredTags;
+    std::vector<std::string> excludedTags;
+    std::vector<std::string> requiredGroups;
+    std::vector<std::string> excludedGroups;
+
+    // the registry rebuilds the entity list directly when restoring a snapshot
+    // or reordering it, and then calls RebuildEntityIndices
+    friend class Registry;
+    void RebuildEntityIndices();
 
 public:
     System() = default;
@@ -87,18 +138,94 @@ public:
 
     void AddEntity(Entity entity);
     void RemoveEntity(Entity entity);
+    bool HasEntity(Entity entity) const;
 
     std::vector<Entity> GetEntities() const;
+    // the list itself instead of a copy, for per step loops. Only valid until
+    // the next Registry::Update, which adds, removes and reorders entities.
+    const std::vector<Entity>& GetEntityList() const;
+    unsigned int GetEntitiesVersion() const;
     const Signature& GetComponentSignature() const;
+    const Signature& GetExcludedComponentSignature() const;
+
+    // decides whether the system should process the given entity. This is only
+    // evaluated when the entity's signature, tag or group changes, never per frame.
+    bool IsInterestedIn(Entity entity, const Signature& entityComponentSignature) const;
 
     template<typename TComponent>
     void RequireComponent();
+
+    template<typename TComponent>
+    void ExcludeComponent();
+
+    void RequireTag(const std::string& tag);
+    void ExcludeTag(const std::string& tag);
+    void RequireGroup(const std::string& group);
+    void ExcludeGroup(const std::string& group);
 };
 
+// interleaves the bits of x and y, so points close in 2D get close codes
+uint64_t MortonCode(uint32_t x, uint32_t y);
+
 class BasePool {
+protected:
+    // Every distinct pool state gets a unique version, so snapshots can skip
+    // pools that did not change since they were captured (copy-on-write).
+    // Mutations only flip isDirty, the version is resolved lazily.
+    static unsigned long long nextVersion;
+    unsigned long long version = 0;
+    bool isDirty = true;
+
+    // Incremental reordering: the plan lists entity IDs in the desired order
+    // and StepReorder moves a bounded number of them into place per call.
+    std::vector<int> reorderPlan;
+    size_t reorderCursor = 0;
+    int reorderPlaced = 0;
+    // whether the current pass swapped any element
+    bool hasReorderMoved = false;
+    // set whenever an element is added or removed
+    bool isOrderDirty = true;
+    // bumped whenever the element order changes, swaps included
+    unsigned long long orderVersion = 0;
+
 public:
     virtual ~BasePool() = default;
     virtual void RemoveEntityFromPool(int entityID) = 0;
+
+    virtual int GetSize() const = 0;
+    // returns -1 when the entity has no element in the pool
+    virtual int GetIndexOf(int entityID) const = 0;
+    virtual int GetEntityIDAt(int index) const = 0;
+    virtual void Swap(int indexA, int indexB) = 0;
+
+    bool IsReordering() const;
+    bool IsOrderDirty() const;
+    // takes over the given entity order, the vector receives the previous plan's buffer
+    void BeginReorder(std::vector<int>& entityOrder);
+    // visits up to maxSteps entries of the plan, returns true when the plan is complete
+    bool StepReorder(int maxSteps);
+    // whether the last (or current) pass moved anything, a pass over an
+    // already ordered pool leaves the element order as it was
+    bool HasReorderMoved() const;
+    unsigned long long GetOrderVersion() const;
+
+    // returns a new pool of the same component type holding a copy of this one
+    virtual std::shared_ptr<BasePool> Clone() = 0;
+    // overwrites this pool with the contents of another pool of the same component type
+    virtual void CopyFrom(BasePool& other) = 0;
+    virtual void Clear() = 0;
+
+    unsigned long long GetVersion() {
+        if (isDirty) {
+            version = ++nextVersion;
+            isDirty = false;
+        }
+        return version;
+    }
+
+    void MarkDirty() {
+        isDirty = true;
+    }
 };
 
 template<typename T>
@@ -106,8 +233,10 @@ class Pool : public BasePool {
 private:
     std::vector<T> data;
     int size;
-    std::unordered_map<int, int> entityIDToIndex;
-    std::unordered_map<int, int> indexToEntityID;
+    // sparse array indexed by entity ID, holds the index into data or -1
+    std::vector<int> entityIDToIndex;
+    // dense array parallel to data, holds the entity ID of every element
+    std::vector<int> indexToEntityID;
 
 public:
     Pool(int capacity = 100) {
@@ -121,33 +250,57 @@ public:
         return size == 0;
     }
 
-    int GetSize() const {
+    int GetSize() const override {
         return size;
     }
 
-    void Clear() {
-        data.clear();
+    void Clear() override {
         entityIDToIndex.clear();
         indexToEntityID.clear();
         size = 0;
+        MarkDirty();
+        isOrderDirty = true;
+        orderVersion++;
     }
 
-    // void Add(T component) {
-    //     data.push_back(component);
-    // }
+    int GetIndexOf(const int entityID) const override {
+        return Contains(entityID) ? entityIDToIndex[entityID] : -1;
+    }
+
+    int GetEntityIDAt(const int index) const override {
+        return indexToEntityID[index];
+    }
+
+    void Swap(const int indexA, const int indexB) override {
+        MarkDirty();
+        orderVersion++;
+        std::swap(data[indexA], data[indexB]);
+        std::swap(indexToEntityID[indexA], indexToEntityID[indexB]);
+        entityIDToIndex[indexToEntityID[indexA]] = indexA;
+        entityIDToIndex[indexToEntityID[indexB]] = indexB;
+    }
+
+    bool Contains(const int entityID) const {
+        return entityID < static_cast<int>(entityIDToIndex.size()) && entityIDToIndex[entityID] != -1;
+    }
 
     void Set(int entityID, T object) {
-        if (entityIDToIndex.find(entityID) != entityIDToIndex.end()) {
-            int index = entityIDToIndex[entityID];
-            data[index] = object;
+        MarkDirty();
+        if (Contains(entityID)) {
+            data[entityIDToIndex[entityID]] = object;
             return;
         }
 
+        isOrderDirty = true;
+        orderVersion++;
         int index = size;
-        entityIDToIndex.emplace(entityID, index);
-        indexToEntityID.emplace(index, entityID);
-        if (index >= static_cast<int>(data.capacity())) {
-            data.resize(size * 2);
+        if (entityID >= static_cast<int>(entityIDToIndex.size())) {
+            entityIDToIndex.resize(entityID + 1, -1);
+        }
+        entityIDToIndex[entityID] = index;
+        indexToEntityID.push_back(entityID);
+        if (index >= static_cast<int>(data.size())) {
+            data.resize(std::max(1, size * 2));
         }
 
         data[index] = object;
@@ -155,6 +308,9 @@ public:
     }
 
     void Remove(const int entityID) {
+        MarkDirty();
+        isOrderDirty = true;
+        orderVersion++;
         const int indexOfRemoved = entityIDToIndex[entityID];
         const int indexOfLast = size - 1;
         data[indexOfRemoved] = data[indexOfLast];
@@ -163,28 +319,93 @@ public:
         entityIDToIndex[entityIDOfLastEmenent] = indexOfRemoved;
         indexToEntityID[indexOfRemoved] = entityIDOfLastEmenent;
 
-        entityIDToIndex.erase(entityID);
-        indexToEntityID.erase(indexOfLast);
+        entityIDToIndex[entityID] = -1;
+        indexToEntityID.pop_back();
 
         size--;
     }
 
     void RemoveEntityFromPool(const int entityID) override {
-        if (entityIDToIndex.find(entityID) != entityIDToIndex.end()) {
+        if (Contains(entityID)) {
             Remove(entityID);
         }
     }
 
+    std::shared_ptr<BasePool> Clone() override {
+        GetVersion();
+        return std::make_shared<Pool<T>>(*this);
+    }
+
+    void CopyFrom(BasePool& other) override {
+        auto& otherPool = static_cast<Pool<T>&>(other);
+        if (static_cast<int>(data.size()) < otherPool.size) {
+            data.resize(otherPool.data.size());
+        }
+        // only the live elements are copied, the rest of data is scratch space
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            std::memcpy(data.data(), otherPool.data.data(), sizeof(T) * otherPool.size);
+        } else {
+            std::copy(otherPool.data.begin(), otherPool.data.begin() + otherPool.size, data.begin());
+        }
+        entityIDToIndex = otherPool.entityIDToIndex;
+        indexToEntityID = otherPool.indexToEntityID;
+        size = otherPool.size;
+        version = otherPool.GetVersion();
+        isDirty = false;
+        isOrderDirty = true;
+        orderVersion++;
+    }
+
+    // mutable access counts as a change, snapshots copy the pool again
     T& Get(const int entityID) {
+        MarkDirty();
         int index = entityIDToIndex[entityID];
         return static_cast<T&>(data[index]);
     }
 
+    // read only access leaves the version alone
+    const T& Get(const int entityID) const {
+        return data[entityIDToIndex[entityID]];
+    }
+
     T& operator [](unsigned int index) {
+        MarkDirty();
         return data[index];
     }
+
+    const T& operator [](unsigned int index) const {
+        return data[index];
+    }
+};
+
+// A copy of the registry state that Registry::CaptureSnapshot fills and
+// Registry::RestoreSnapshot writes back, used for rollback and speculative
+// simulation. The buffers are reused between captures, so after the first
+// capture taking a snapshot does not allocate unless the world grew. Pools
+// that did not change since the last capture/restore are not copied again.
+// A snapshot can only be restored into the registry it was captured from.
+class RegistrySnapshot {
+private:
+    friend class Registry;
+
+    int numEntities = 0;
+    std::vector<std::shared_ptr<BasePool>> componentPools;
+    std::vector<Signature> entityComponentSignatures;
+    std::vector<bool> disabledEntities;
+    std::vector<uint64_t> entityLabels;
+    std::unordered_map<std::type_index, std::vector<Entity>> systemEntities;
+    std::set<Entity> entitiesToCreate;
+    std::set<Entity> entitiesToDestroy;
+    std::deque<int> freeIDs;
+    std::unordered_map<std::string, Entity> entityPerTag;
+    std::unordered_map<int, std::string> tagPerEntity;
+    std::unordered_map<std::string, std::set<Entity>> entitiesPerGroup;
+    std::unordered_map<int, std::string> groupPerEntity;
 };
 
+class SpatialIndex;
+struct RaycastHit;
+
 class Registry {
 private:
     int numEntities = 0;
@@ -200,6 +421,10 @@ private:
     // index = entityID
     std::vector<Signature> entityComponentSignatures;
 
+    // Entities taken out of every system without touching their components
+    // index = entityID
+    std::vector<bool> disabledEntities;
+
     std::unordered_map<std::type_index, std::shared_ptr<System>> systems;
 
     std::set<Entity> entitiesToCreate;
@@ -214,6 +439,31 @@ private:
     std::unordered_map<std::string, std::set<Entity>> entitiesPerGroup;
     std::unordered_map<int, std::string> groupPerEntity;
 
+    // EntityLabels bits of the tag and group of each entity
+    // index = entityID
+    std::vector<uint64_t> entityLabels;
+
+    // Pool ordering policies, keyed by component ID and advanced from Update
+    struct PoolOrderPolicy {
+        // fills the vector with entity IDs in the desired order
+        std::function<void(std::vector<int>&)> planOrder;
+        // optional, also plan again when this changed since the last pass,
+        // not only after elements were added/removed
+        std::function<unsigned long long()> watchedVersion;
+        int stepsPerFrame;
+        unsigned long long plannedVersion = 0;
+    };
+    std::unordered_map<int, PoolOrderPolicy> poolOrderPolicies;
+    std::vector<int> poolOrderScratch;
+    // systems iterate their entities in the order of this pool, -1 keeps insertion order
+    int iterationOrderComponentID = -1;
+
+    // answers the spatial queries, owned by the collision system
+    const SpatialIndex* spatialIndex = nullptr;
+
+    void UpdatePoolOrdering();
+    void SortSystemsByPool(int componentID) const;
+
 public:
     Registry() = default;
     ~Registry() = default;
@@ -225,6 +475,19 @@ public:
     void DestroyEntity(Entity entity);
     void RemoveEntityFromSystems(Entity entity) const;
     void AddEntityToSystems(Entity entity) const;
+    // re-evaluates the system membership of an entity that is already alive,
+    // called whenever its components, tag or group change
+    void RefreshEntityInSystems(Entity entity);
+
+    // Enable/disable, O(number of systems) and without any allocation or pool
+    // changes, used for pooled projectiles, off-screen enemies, paused UI...
+    void EnableEntity(Entity entity);
+    void DisableEntity(Entity entity);
+    bool IsEntityEnabled(Entity entity) const;
+
+    // Snapshots
+    void CaptureSnapshot(RegistrySnapshot& snapshot) const;
+    void RestoreSnapshot(const RegistrySnapshot& snapshot);
 
     // Tag management
     void TagEntity(Entity entity, const std::string& tag);
@@ -238,6 +501,20 @@ public:
     std::vector<Entity> GetEntitiesByGroup(const std::string& group) const;
     void RemoveEntityGroup(Entity entity);
 
+    uint64_t GetEntityLabels(Entity entity) const;
+
+    // Spatial queries over the entities with a box collider, as of the last
+    // collision pass, see SpatialIndex. layerMask picks the collision layers.
+    void SetSpatialIndex(const SpatialIndex* spatialIndex);
+    std::vector<Entity> QueryAABB(double minX, double minY, double maxX, double maxY,
+                                  uint32_t layerMask = 0xFFFFFFFF) const;
+    std::vector<Entity> QueryRadius(double x, double y, double radius, uint32_t layerMask = 0xFFFFFFFF) const;
+    // the first collider hit going from (x, y) towards (directionX, directionY)
+    bool Raycast(double x, double y, double directionX, double directionY, double maxDistance, RaycastHit& hit,
+                 uint32_t layerMask = 0xFFFFFFFF) const;
+    // the k colliders closest to (x, y), closest first
+    std::vector<Entity> Nearest(double x, double y, int k, uint32_t layerMask = 0xFFFFFFFF) const;
+
     // Components
     template<typename TComponent, typename... TComponentArgs>
     void AddComponent(Entity entity, TComponentArgs&&... args);
@@ -248,9 +525,38 @@ public:
     template<typename TComponent>
     bool HasComponent(Entity entity) const;
 
+    // marks the component's pool as changed, use ReadComponent when the
+    // component is only read so snapshots can skip the pool
     template<typename TComponent>
     TComponent& GetComponent(Entity entity) const;
 
+    template<typename TComponent>
+    const TComponent& ReadComponent(Entity entity) const;
+
+    // the pool of a component type, nullptr until an entity gets one. Hot
+    // loops look their components up in it once instead of per entity.
+    template<typename TComponent>
+    Pool<TComponent>* GetComponentPool() const;
+
+    // Pool ordering. Swap-and-pop removal leaves pools in arbitrary order, these
+    // policies put them back in order a few hundred elements per frame.
+    template<typename TComponent>
+    void SortPoolByEntityID(int stepsPerFrame = 256);
+
+    // keeps the pool in the same entity order as the leading pool, so systems
+    // walking several components touch all of them front to back
+    template<typename TComponent, typename TLeadingComponent>
+    void SortPoolLike(int stepsPerFrame = 256);
+
+    // keeps the pool sorted by an arbitrary key, e.g. a Morton code of the position
+    template<typename TComponent>
+    void SortPoolByKey(std::function<uint64_t(Entity)> key, int stepsPerFrame = 256);
+
+    // every time the pool finishes a reorder pass that moved something,
+    // systems requiring the component re-sort their entity list to follow it
+    template<typename TComponent>
+    void IterateSystemsInPoolOrder();
+
     // Systems
     template<typename TSystem, typename... TSystemArgs>
     void AddSystem(TSystemArgs&&... args);
@@ -285,34 +591,50 @@ TComponent& Entity::GetComponent() const {
     return this->registry->GetComponent<TComponent>(*this);
 }
 
+template<typename TComponent>
+const TComponent& Entity::ReadComponent() const {
+    return this->registry->ReadComponent<TComponent>(*this);
+}
+
 template<typename TComponent>
 void System::RequireComponent() {
     const auto componentID = Component<TComponent>::GetID();
     this->componentSignature.set(componentID);
 }
 
+template<typename TComponent>
+void System::ExcludeComponent() {
+    const auto componentID = Component<TComponent>::GetID();
+    this->excludedComponentSignature.set(componentID);
+}
+
 template<typename TComponent, typename... TComponentArgs>
 void Registry::AddComponent(const Entity entity, TComponentArgs&&... args) {
     const auto componentID = Component<TComponent>::GetID();
     const auto entityID = entity.GetID();
 
-    if (componentID >= static_cast<int>(componentPools.size())) {
-        componentPools.resize(componentID + 1, nullptr);
-    }
+    // components without data (markers like the camera follow) only live in
+    // the signature, they never get a pool
+    if constexpr (!std::is_empty_v<TComponent>) {
+        if (componentID >= static_cast<int>(componentPools.size())) {
+            componentPools.resize(componentID + 1, nullptr);
+        }
 
-    if (!componentPools[componentID]) {
-        std::shared_ptr<Pool<TComponent>> newComponentPool(new Pool<TComponent>);
-        componentPools[componentID] = newComponentPool;
-    }
+        if (!componentPools[componentID]) {
+            std::shared_ptr<Pool<TComponent>> newComponentPool(new Pool<TComponent>);
+            componentPools[componentID] = newComponentPool;
+        }
 
-    std::shared_ptr<Pool<TComponent>> componentPool = std::static_pointer_cast<Pool<TComponent>>(
-        componentPools[componentID]
-    );
+        std::shared_ptr<Pool<TComponent>> componentPool = std::static_pointer_cast<Pool<TComponent>>(
+            componentPools[componentID]
+        );
 
-    TComponent newComponent(std::forward<TComponentArgs>(args)...);
-    componentPool->Set(entityID, newComponent);
+        TComponent newComponent(std::forward<TComponentArgs>(args)...);
+        componentPool->Set(entityID, newComponent);
+    }
 
     entityComponentSignatures[entityID].set(componentID);
+    RefreshEntityInSystems(entity);
 }
 
 template<typename TComponent>
@@ -320,12 +642,15 @@ void Registry::RemoveComponent(const Entity entity) {
     const auto componentID = Component<TComponent>::GetID();
     const auto entityID = entity.GetID();
 
-    std::shared_ptr<Pool<TComponent>> componentPool = std::static_pointer_cast<Pool<TComponent>>(
-        componentPools[componentID]
-    );
-    componentPool->Remove(entityID);
+    if constexpr (!std::is_empty_v<TComponent>) {
+        std::shared_ptr<Pool<TComponent>> componentPool = std::static_pointer_cast<Pool<TComponent>>(
+            componentPools[componentID]
+        );
+        componentPool->Remove(entityID);
+    }
 
     entityComponentSignatures[entityID].set(componentID, false);
+    RefreshEntityInSystems(entity);
 }
 
 template<typename TComponent>
@@ -338,14 +663,114 @@ bool Registry::HasComponent(const Entity entity) const {
 
 template<typename TComponent>
 TComponent& Registry::GetComponent(const Entity entity) const {
+    // every entity shares the same instance of a component without data
+    if constexpr (std::is_empty_v<TComponent>) {
+        static TComponent emptyComponent;
+        return emptyComponent;
+    } else {
+        const auto componentID = Component<TComponent>::GetID();
+        const auto entityID = entity.GetID();
+
+        std::shared_ptr<Pool<TComponent>> componentPool = std::static_pointer_cast<Pool<TComponent>>(
+            componentPools[componentID]
+        );
+
+        return componentPool->Get(entityID);
+    }
+}
+
+template<typename TComponent>
+const TComponent& Registry::ReadComponent(const Entity entity) const {
+    if constexpr (std::is_empty_v<TComponent>) {
+        static const TComponent emptyComponent{};
+        return emptyComponent;
+    } else {
+        const auto componentID = Component<TComponent>::GetID();
+        const auto* componentPool = static_cast<const Pool<TComponent>*>(componentPools[componentID].get());
+        return componentPool->Get(entity.GetID());
+    }
+}
+
+template<typename TComponent>
+Pool<TComponent>* Registry::GetComponentPool() const {
+    static_assert(!std::is_empty_v<TComponent>, "components without data have no pool");
     const auto componentID = Component<TComponent>::GetID();
-    const auto entityID = entity.GetID();
+    if (componentID >= static_cast<int>(componentPools.size())) {
+        return nullptr;
+    }
+    return static_cast<Pool<TComponent>*>(componentPools[componentID].get());
+}
 
-    std::shared_ptr<Pool<TComponent>> componentPool = std::static_pointer_cast<Pool<TComponent>>(
-        componentPools[componentID]
-    );
+template<typename TComponent>
+void Registry::SortPoolByEntityID(const int stepsPerFrame) {
+    const auto componentID = Component<TComponent>::GetID();
+    poolOrderPolicies[componentID] = PoolOrderPolicy{
+        [this, componentID](std::vector<int>& entityOrder) {
+            const auto& pool = componentPools[componentID];
+            for (int i = 0; i < pool->GetSize(); i++) {
+                entityOrder.push_back(pool->GetEntityIDAt(i));
+            }
+            std::sort(entityOrder.begin(), entityOrder.end());
+        },
+        nullptr,
+        stepsPerFrame
+    };
+}
 
-    return componentPool->Get(entityID);
+template<typename TComponent, typename TLeadingComponent>
+void Registry::SortPoolLike(const int stepsPerFrame) {
+    const auto componentID = Component<TComponent>::GetID();
+    const auto leadingComponentID = Component<TLeadingComponent>::GetID();
+    poolOrderPolicies[componentID] = PoolOrderPolicy{
+        [this, leadingComponentID](std::vector<int>& entityOrder) {
+            if (leadingComponentID >= static_cast<int>(componentPools.size()) || !componentPools[leadingComponentID]) {
+                return;
+            }
+            // entities missing from this pool are skipped while stepping
+            const auto& leadingPool = componentPools[leadingComponentID];
+            for (int i = 0; i < leadingPool->GetSize(); i++) {
+                entityOrder.push_back(leadingPool->GetEntityIDAt(i));
+            }
+        },
+        // only the leading pool's order matters, not its data
+        [this, leadingComponentID]() -> unsigned long long {
+            if (leadingComponentID >= static_cast<int>(componentPools.size()) || !componentPools[leadingComponentID]) {
+                return 0;
+            }
+            return componentPools[leadingComponentID]->GetOrderVersion();
+        },
+        stepsPerFrame
+    };
+}
+
+template<typename TComponent>
+void Registry::SortPoolByKey(std::function<uint64_t(Entity)> key, const int stepsPerFrame) {
+    const auto componentID = Component<TComponent>::GetID();
+    poolOrderPolicies[componentID] = PoolOrderPolicy{
+        [this, componentID, key, keys = std::vector<std::pair<uint64_t, int>>()](std::vector<int>& entityOrder) mutable {
+            const auto& pool = componentPools[componentID];
+            keys.clear();
+            for (int i = 0; i < pool->GetSize(); i++) {
+                Entity entity(pool->GetEntityIDAt(i));
+                entity.registry = this;
+                keys.emplace_back(key(entity), entity.GetID());
+            }
+            std::sort(keys.begin(), keys.end());
+            for (const auto& entry: keys) {
+                entityOrder.push_back(entry.second);
+            }
+        },
+        // any change of the pool's data may change the keys
+        [this, componentID]() {
+            return componentPools[componentID]->GetVersion();
+        },
+        stepsPerFrame
+    };
+}
+
+template<typename TComponent>
+void Registry::IterateSystemsInPoolOrder() {
+    iterationOrderComponentID = Component<TComponent>::GetID();
 }
 
 template<typename TSystem, typename... TSystemArgs>
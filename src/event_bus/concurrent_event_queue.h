@@ -0,0 +1,113 @@
+#ifndef CONCURRENT_EVENT_QUEUE_H
+#define CONCURRENT_EVENT_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+
+// Lock-free, bounded, multi-producer single-consumer queue of events.
+// Any number of worker threads may Emit/TryEmit concurrently, only one thread
+// (the main thread) may Drain. Every slot carries a sequence number that tells
+// producers and the consumer whose turn it is, so no locks are taken and
+// nothing is allocated after construction.
+template<typename TEvent>
+class ConcurrentEventQueue {
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        alignas(TEvent) unsigned char storage[sizeof(TEvent)];
+    };
+
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    // producers and the consumer write on different cache lines
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueuePosition;
+    alignas(CACHE_LINE_SIZE) size_t dequeuePosition;
+
+public:
+    // capacity is rounded up to a power of two
+    explicit ConcurrentEventQueue(size_t capacity = 4096) : enqueuePosition(0), dequeuePosition(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        cells = std::make_unique<Cell[]>(size);
+        mask = size - 1;
+        for (size_t i = 0; i < size; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~ConcurrentEventQueue() {
+        Drain([](TEvent&&) {});
+    }
+
+    ConcurrentEventQueue(const ConcurrentEventQueue&) = delete;
+    ConcurrentEventQueue& operator =(const ConcurrentEventQueue&) = delete;
+
+    size_t GetCapacity() const {
+        return mask + 1;
+    }
+
+    // safe from any thread, returns false when the queue is full
+    template<typename... TArgs>
+    bool TryEmit(TArgs&&... args) {
+        size_t position = enqueuePosition.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells[position & mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (difference == 0) {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+        new(cell->storage) TEvent(std::forward<TArgs>(args)...);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // safe from any thread, yields while the consumer catches up on a full queue
+    template<typename... TArgs>
+    void Emit(TArgs&&... args) {
+        while (!TryEmit(args...)) {
+            std::this_thread::yield();
+        }
+    }
+
+    // consumer thread only. Hands every event published so far to the
+    // callback, oldest first, and returns how many there were. Stops after
+    // one full lap so producers that never stop cannot keep it busy forever.
+    template<typename TCallback>
+    size_t Drain(TCallback&& callback) {
+        size_t drained = 0;
+        while (drained <= mask) {
+            Cell& cell = cells[dequeuePosition & mask];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(dequeuePosition + 1) < 0) {
+                break;
+            }
+            TEvent* event = std::launder(reinterpret_cast<TEvent*>(cell.storage));
+            callback(std::move(*event));
+            event->~TEvent();
+            cell.sequence.store(dequeuePosition + mask + 1, std::memory_order_release);
+            dequeuePosition++;
+            drained++;
+        }
+        return drained;
+    }
+};
+
+#endif //CONCURRENT_EVENT_QUEUE_H
@@ -5,52 +5,222 @@
 #ifndef EVENT_BUS_H
 #define EVENT_BUS_H
 
-#include <list>
-#include <map>
-#include <typeindex>
+#include <cstring>
 #include <memory>
-#include <functional>
+#include <vector>
 
 #include "../logger/logger.h"
 #include "event.h"
+#include "event_channel.h"
+#include "event_tracer.h"
 
-class EventCallbackBase {
-private:
-    virtual void Call(Event& e) = 0;
+struct BaseEventType {
+protected:
+    inline static int nextID = 0;
+};
 
+// used to assign a unique, dense id to an event type, so handler lists can
+// live in a vector indexed by it instead of a map keyed by type_index
+template<typename TEvent>
+class EventType : public BaseEventType {
 public:
-    virtual ~EventCallbackBase() = default;
-    void Execute(Event& e) {
-        Call(e);
+    static int GetID() {
+        static int id = nextID++;
+        return id;
+    }
+};
+
+// A handler stored by value: the owner instance, the member function to call
+// on it and a plain function (the thunk) that knows their types. Calling one
+// is a single indirect call, no heap node or virtual table in between.
+struct EventDelegate {
+    void* owner;
+    void (*thunk)(const EventDelegate& delegate, Event& e);
+    // the member function pointer, copied in as raw bytes
+    alignas(void*) unsigned char callback[2 * sizeof(void*)];
+    // stable id used by EventSubscription, the index in the list changes on removal
+    int slot;
+#ifdef EVENT_TRACING
+    uint16_t handlerNameID;
+#endif
+
+    template<typename TOwner, typename TEvent>
+    static void Invoke(const EventDelegate& delegate, Event& e) {
+        void (TOwner::*callbackFunction)(TEvent&);
+        std::memcpy(&callbackFunction, delegate.callback, sizeof(callbackFunction));
+        (static_cast<TOwner*>(delegate.owner)->*callbackFunction)(static_cast<TEvent&>(e));
+    }
+
+    // the member function is known at compile time, so it gets called (or
+    // inlined) directly from the thunk
+    template<typename TOwner, typename TEvent, void (TOwner::*CallbackFunction)(TEvent&)>
+    static void InvokeStatic(const EventDelegate& delegate, Event& e) {
+        (static_cast<TOwner*>(delegate.owner)->*CallbackFunction)(static_cast<TEvent&>(e));
     }
 };
 
+// splits a member function pointer type into its owner and event types
+template<typename TCallbackFunction>
+struct EventCallbackTraits;
+
 template<typename TOwner, typename TEvent>
-class EventCallback : public EventCallbackBase {
+struct EventCallbackTraits<void (TOwner::*)(TEvent&)> {
+    using Owner = TOwner;
+    using EventClass = TEvent;
+};
+
+// the contiguous handlers of one event type
+class HandlerList {
 private:
-    typedef void (TOwner::*CallbackFunction)(TEvent&);
+    std::vector<EventDelegate> delegates;
+    // slot -> index in delegates, -1 when the slot is free
+    std::vector<int> slotToIndex;
+    std::vector<int> freeSlots;
+    bool hasPendingRemovals = false;
 
-    TOwner* ownerInstance;
-    CallbackFunction callbackFunction;
+public:
+    // > 0 while EmitEvent walks the list, removals are deferred until it is done
+    int dispatchDepth = 0;
 
-    void Call(Event& e) override {
-        std::invoke(callbackFunction, ownerInstance, static_cast<TEvent&>(e));
+    size_t GetSize() const {
+        return delegates.size();
     }
 
-public:
-    EventCallback(TOwner* ownerInstance, CallbackFunction callbackFunction) : ownerInstance(ownerInstance),
-                                                                              callbackFunction(callbackFunction) {
-        this->ownerInstance = ownerInstance;
-        this->callbackFunction = callbackFunction;
-    };
-    ~EventCallback() override = default;
+    const EventDelegate& Get(const size_t index) const {
+        return delegates[index];
+    }
+
+    int Add(EventDelegate delegate) {
+        if (freeSlots.empty()) {
+            delegate.slot = static_cast<int>(slotToIndex.size());
+            slotToIndex.push_back(-1);
+        } else {
+            delegate.slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        slotToIndex[delegate.slot] = static_cast<int>(delegates.size());
+        delegates.push_back(delegate);
+        return delegate.slot;
+    }
+
+    void Remove(const int slot) {
+        const int index = slotToIndex[slot];
+        if (dispatchDepth > 0) {
+            // the emitter skips empty delegates, RemovePending erases them afterwards
+            delegates[index].thunk = nullptr;
+            hasPendingRemovals = true;
+            return;
+        }
+        const EventDelegate& last = delegates.back();
+        slotToIndex[last.slot] = index;
+        delegates[index] = last;
+        delegates.pop_back();
+        slotToIndex[slot] = -1;
+        freeSlots.push_back(slot);
+    }
+
+    void RemoveAll() {
+        for (int slot = 0; slot < static_cast<int>(slotToIndex.size()); slot++) {
+            if (slotToIndex[slot] != -1) {
+                Remove(slot);
+            }
+        }
+    }
+
+    void RemovePending() {
+        if (!hasPendingRemovals) {
+            return;
+        }
+        // compact in place, keeping the order of the remaining handlers
+        size_t kept = 0;
+        for (size_t i = 0; i < delegates.size(); i++) {
+            const EventDelegate delegate = delegates[i];
+            if (!delegate.thunk) {
+                slotToIndex[delegate.slot] = -1;
+                freeSlots.push_back(delegate.slot);
+                continue;
+            }
+            slotToIndex[delegate.slot] = static_cast<int>(kept);
+            delegates[kept++] = delegate;
+        }
+        delegates.resize(kept);
+        hasPendingRemovals = false;
+    }
 };
 
-typedef std::list<std::unique_ptr<EventCallbackBase>> HandlerList;
+// RAII handle returned by SubscribeToEvent, the subscription lasts until the
+// handle is destroyed or Unsubscribe is called. Unsubscribing is O(1) and is
+// safe from inside an event handler, even for the handler being dispatched.
+class EventSubscription {
+private:
+    // weak so handles outliving the event bus do not touch freed memory
+    std::weak_ptr<HandlerList> handlers;
+    int slot = -1;
+
+public:
+    EventSubscription() = default;
+
+    EventSubscription(std::weak_ptr<HandlerList> handlers, const int slot) : handlers(std::move(handlers)),
+                                                                             slot(slot) {
+    }
+
+    EventSubscription(const EventSubscription&) = delete;
+    EventSubscription& operator =(const EventSubscription&) = delete;
+
+    EventSubscription(EventSubscription&& other) noexcept : handlers(std::move(other.handlers)),
+                                                          slot(other.slot) {
+        other.handlers.reset();
+    }
+
+    EventSubscription& operator =(EventSubscription&& other) noexcept {
+        if (this != &other) {
+            Unsubscribe();
+            handlers = std::move(other.handlers);
+            slot = other.slot;
+            other.handlers.reset();
+        }
+        return *this;
+    }
+
+    ~EventSubscription() {
+        Unsubscribe();
+    }
+
+    bool IsActive() const {
+        return !handlers.expired();
+    }
+
+    void Unsubscribe() {
+        if (const auto handlerList = handlers.lock()) {
+            handlerList->Remove(slot);
+        }
+        handlers.reset();
+    }
+};
 
 class EventBus {
 private:
-    std::map<std::type_index, std::unique_ptr<HandlerList>> subscribers;
+    // index = event type ID
+    std::vector<std::shared_ptr<HandlerList>> subscribers;
+
+    // lists dropped by a Reset issued from inside a handler, kept alive until
+    // the outermost EmitEvent returns
+    int dispatchDepth = 0;
+    std::vector<std::shared_ptr<HandlerList>> retiredHandlers;
+
+    // queued channels, index = event type ID
+    std::vector<std::unique_ptr<BaseEventChannel>> channels;
+
+    EventSubscription AddDelegate(const int eventID, const EventDelegate& delegate) {
+        if (eventID >= static_cast<int>(subscribers.size())) {
+            subscribers.resize(eventID + 1);
+        }
+        auto& handlers = subscribers[eventID];
+        if (!handlers) {
+            handlers = std::make_shared<HandlerList>();
+        }
+        return EventSubscription(handlers, handlers->Add(delegate));
+    }
 
 public:
     EventBus() {
@@ -61,30 +231,121 @@ public:
         Logger::Log("Event bus destroyed");
     }
 
-    // clears the subs list
+    // drops every subscription, outstanding handles become inactive
     void Reset() {
+        if (dispatchDepth > 0) {
+            for (auto& handlers: subscribers) {
+                if (handlers) {
+                    handlers->RemoveAll();
+                    retiredHandlers.push_back(std::move(handlers));
+                }
+            }
+        }
         this->subscribers.clear();
     }
 
+    // eventBus->SubscribeToEvent<&Owner::OnEvent>(owner), preferred since the
+    // handler is called directly
+    template<auto CallbackFunction>
+    [[nodiscard]] EventSubscription SubscribeToEvent(typename EventCallbackTraits<decltype(CallbackFunction)>::Owner* ownerInstance) {
+        using TOwner = typename EventCallbackTraits<decltype(CallbackFunction)>::Owner;
+        using TEvent = typename EventCallbackTraits<decltype(CallbackFunction)>::EventClass;
+
+        EventDelegate delegate{};
+        delegate.owner = ownerInstance;
+        delegate.thunk = &EventDelegate::InvokeStatic<TOwner, TEvent, CallbackFunction>;
+#ifdef EVENT_TRACING
+        delegate.handlerNameID = EventTracer::InternType(typeid(TOwner));
+#endif
+        return AddDelegate(EventType<TEvent>::GetID(), delegate);
+    }
+
+    // eventBus->SubscribeToEvent<Event>(owner, &Owner::OnEvent), for member
+    // functions only known at runtime
     template<typename TEvent, typename TOwner>
-    void SubscribeToEvent(TOwner* ownerInstance, void (TOwner::*callbackFunction)(TEvent&)) {
-        if (!subscribers[typeid(TEvent)].get()) {
-            subscribers[typeid(TEvent)] = std::make_unique<HandlerList>();
+    [[nodiscard]] EventSubscription SubscribeToEvent(TOwner* ownerInstance, void (TOwner::*callbackFunction)(TEvent&)) {
+        static_assert(sizeof(callbackFunction) <= sizeof(EventDelegate::callback), "member function pointer too big");
+
+        EventDelegate delegate{};
+        delegate.owner = ownerInstance;
+        delegate.thunk = &EventDelegate::Invoke<TOwner, TEvent>;
+        std::memcpy(delegate.callback, &callbackFunction, sizeof(callbackFunction));
+#ifdef EVENT_TRACING
+        delegate.handlerNameID = EventTracer::InternType(typeid(TOwner));
+#endif
+        return AddDelegate(EventType<TEvent>::GetID(), delegate);
+    }
+
+    // the queued channel for an event type, see EventChannel
+    template<typename TEvent>
+    EventChannel<TEvent>& GetChannel() {
+        const auto eventID = EventType<TEvent>::GetID();
+        if (eventID >= static_cast<int>(channels.size())) {
+            channels.resize(eventID + 1);
+        }
+        if (!channels[eventID]) {
+            channels[eventID] = std::make_unique<EventChannel<TEvent>>();
+        }
+        return static_cast<EventChannel<TEvent>&>(*channels[eventID]);
+    }
+
+    // the thread-safe entry point of a channel. The bus itself is main thread
+    // only, so fetch the queue there and hand the reference to the workers.
+    // Posted events show up in Read after the next SwapChannels.
+    template<typename TEvent>
+    ConcurrentEventQueue<TEvent>& GetConcurrentQueue(const size_t capacity = 4096) {
+        return GetChannel<TEvent>().GetConcurrentQueue(capacity);
+    }
+
+    // publishes the queued events of every channel, called once per frame
+    void SwapChannels() {
+        for (const auto& channel: channels) {
+            if (channel) {
+                channel->Swap();
+            }
         }
-        auto subscriber = std::make_unique<EventCallback<TOwner, TEvent>>(ownerInstance, callbackFunction);
-        subscribers[typeid(TEvent)]->push_back(std::move(subscriber));
     }
 
     template<typename TEvent, typename... TArgs>
     void EmitEvent(TArgs&&... args) {
-        if (const auto handlers = subscribers[typeid(TEvent)].get()) {
-            // for (auto handler: *handlers) {
-            for (auto it = handlers->begin(); it != handlers->end(); ++it) {
-                auto handler = it->get();
-                TEvent event(std::forward<TArgs>(args)...);
-                handler->Execute(event);
+#ifdef EVENT_TRACING
+        EventTracer::RecordEmit<TEvent>();
+#endif
+        const auto eventID = EventType<TEvent>::GetID();
+        if (eventID >= static_cast<int>(subscribers.size()) || !subscribers[eventID]) {
+            return;
+        }
+        HandlerList& handlers = *subscribers[eventID];
+
+        // the event is built once and every handler sees the same instance
+        TEvent event(std::forward<TArgs>(args)...);
+
+        dispatchDepth++;
+        handlers.dispatchDepth++;
+        // handlers may subscribe more handlers, so the size is read every
+        // iteration and the delegate copied before it is called
+        for (size_t i = 0; i < handlers.GetSize(); i++) {
+            const EventDelegate delegate = handlers.Get(i);
+            if (delegate.thunk) {
+#ifdef EVENT_TRACING
+                const uint64_t start = EventTracer::Now();
+                delegate.thunk(delegate, event);
+                EventTracer::Record(EventTracer::GetEventNameID<TEvent>(), delegate.handlerNameID, start,
+                                    EventTracer::Now());
+#else
+                delegate.thunk(delegate, event);
+#endif
             }
         }
+        handlers.dispatchDepth--;
+        dispatchDepth--;
+
+        if (handlers.dispatchDepth == 0) {
+            handlers.RemovePending();
+        }
+        if (dispatchDepth == 0 && !retiredHandlers.empty()) {
+            retiredHandlers.clear();
+        }
     }
 };
 
@@ -0,0 +1,70 @@
+#ifndef EVENT_CHANNEL_H
+#define EVENT_CHANNEL_H
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "concurrent_event_queue.h"
+#include "event_tracer.h"
+
+class BaseEventChannel {
+public:
+    virtual ~BaseEventChannel() = default;
+    virtual void Swap() = 0;
+};
+
+// A queued, double-buffered stream of events of one type. Producers append
+// plain event structs to the write buffer, Swap publishes them and consumers
+// read the whole batch at once at a point of their choosing, instead of
+// having a handler called in the middle of the producer's loop.
+template<typename TEvent>
+class EventChannel : public BaseEventChannel {
+private:
+    std::vector<TEvent> writeBuffer;
+    std::vector<TEvent> readBuffer;
+    // optional entry point for worker threads, drained on the main thread by Swap
+    std::unique_ptr<ConcurrentEventQueue<TEvent>> concurrentQueue;
+
+public:
+    // Emit and Swap are main thread only. Worker threads post through this
+    // queue instead; create it from the main thread before handing it out.
+    ConcurrentEventQueue<TEvent>& GetConcurrentQueue(const size_t capacity = 4096) {
+        if (!concurrentQueue) {
+            concurrentQueue = std::make_unique<ConcurrentEventQueue<TEvent>>(capacity);
+        }
+        return *concurrentQueue;
+    }
+
+    // returns the queued event, valid until the next Emit or Swap
+    template<typename... TArgs>
+    const TEvent& Emit(TArgs&&... args) {
+#ifdef EVENT_TRACING
+        EventTracer::RecordEmit<TEvent>();
+#endif
+        return writeBuffer.emplace_back(std::forward<TArgs>(args)...);
+    }
+
+    // the events published by the last Swap, stable until the next one
+    const std::vector<TEvent>& Read() const {
+        return readBuffer;
+    }
+
+    // publishes everything emitted (or posted to the concurrent queue) since
+    // the last swap, the buffers keep their capacity so steady state emitting
+    // does not allocate
+    void Swap() override {
+        if (concurrentQueue) {
+            concurrentQueue->Drain([this](TEvent&& event) {
+#ifdef EVENT_TRACING
+                EventTracer::RecordEmit<TEvent>();
+#endif
+                writeBuffer.push_back(std::move(event));
+            });
+        }
+        readBuffer.swap(writeBuffer);
+        writeBuffer.clear();
+    }
+};
+
+#endif //EVENT_CHANNEL_H
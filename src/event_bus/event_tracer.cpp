@@ -0,0 +1,136 @@
+#include "event_tracer.h"
+
+#ifdef EVENT_TRACING
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include "../logger/logger.h"
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+// index = name id, the first entries are the reserved ids
+std::vector<std::string> EventTracer::names = {"<emit>", "<unknown>"};
+std::vector<EventTraceRecord> EventTracer::records(CAPACITY);
+size_t EventTracer::nextRecord = 0;
+uint64_t EventTracer::totalRecords = 0;
+uint32_t EventTracer::frame = 0;
+uint16_t EventTracer::currentEmitter = UNKNOWN_EMITTER;
+
+uint16_t EventTracer::Intern(const std::string& name) {
+    // called once per call site, a linear search is fine
+    const auto it = std::find(names.begin(), names.end(), name);
+    if (it != names.end()) {
+        return static_cast<uint16_t>(it - names.begin());
+    }
+    names.push_back(name);
+    return static_cast<uint16_t>(names.size() - 1);
+}
+
+uint16_t EventTracer::InternType(const std::type_info& type) {
+    std::string name = type.name();
+#if defined(__GNUG__)
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+    if (status == 0 && demangled) {
+        name = demangled;
+    }
+    std::free(demangled);
+#endif
+    return Intern(name);
+}
+
+void EventTracer::LogSummary() {
+    const size_t count = std::min<uint64_t>(totalRecords, CAPACITY);
+    if (count == 0) {
+        Logger::Log("Event trace is empty");
+        return;
+    }
+
+    struct EventTypeSummary {
+        uint64_t emits = 0;
+        std::vector<uint32_t> handlerDurations;
+    };
+    std::vector<EventTypeSummary> summaries(names.size());
+    uint32_t firstFrame = UINT32_MAX;
+    uint32_t lastFrame = 0;
+    for (size_t i = 0; i < count; i++) {
+        const EventTraceRecord& record = records[i];
+        firstFrame = std::min(firstFrame, record.frame);
+        lastFrame = std::max(lastFrame, record.frame);
+        if (record.handlerNameID == EMIT) {
+            summaries[record.eventNameID].emits++;
+        } else {
+            summaries[record.eventNameID].handlerDurations.push_back(record.duration);
+        }
+    }
+
+    const double frames = lastFrame - firstFrame + 1;
+    const double microsPerTick = 1000000.0 / static_cast<double>(SDL_GetPerformanceFrequency());
+    Logger::Log("Event trace: " + std::to_string(count) + " records over " +
+                std::to_string(static_cast<int>(frames)) + " frames");
+    for (size_t id = 0; id < summaries.size(); id++) {
+        auto& summary = summaries[id];
+        if (summary.emits == 0 && summary.handlerDurations.empty()) {
+            continue;
+        }
+        double p50 = 0;
+        double p99 = 0;
+        auto& durations = summary.handlerDurations;
+        if (!durations.empty()) {
+            std::sort(durations.begin(), durations.end());
+            p50 = durations[(durations.size() - 1) * 50 / 100] * microsPerTick;
+            p99 = durations[(durations.size() - 1) * 99 / 100] * microsPerTick;
+        }
+        char line[256];
+        std::snprintf(line, sizeof(line), "  %s: %llu emits (%.1f/frame), %zu handler calls, p50 %.2fus, p99 %.2fus",
+                      names[id].c_str(), static_cast<unsigned long long>(summary.emits), summary.emits / frames,
+                      durations.size(), p50, p99);
+        Logger::Log(line);
+    }
+}
+
+// Layout, host byte order:
+//   "EVTR", uint32 version, uint64 ticks per second
+//   uint32 name count, then per name a uint16 length and its bytes
+//   uint32 record count, then the EventTraceRecord structs, oldest first
+bool EventTracer::Dump(const std::string& filePath) {
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file) {
+        Logger::Err("Could not open event trace file " + filePath);
+        return false;
+    }
+    const uint32_t version = 1;
+    const uint64_t frequency = SDL_GetPerformanceFrequency();
+    file.write("EVTR", 4);
+    file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    file.write(reinterpret_cast<const char*>(&frequency), sizeof(frequency));
+
+    const auto nameCount = static_cast<uint32_t>(names.size());
+    file.write(reinterpret_cast<const char*>(&nameCount), sizeof(nameCount));
+    for (const auto& name: names) {
+        const auto length = static_cast<uint16_t>(name.size());
+        file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        file.write(name.data(), length);
+    }
+
+    const auto recordCount = static_cast<uint32_t>(std::min<uint64_t>(totalRecords, CAPACITY));
+    file.write(reinterpret_cast<const char*>(&recordCount), sizeof(recordCount));
+    // once the ring has wrapped the oldest record is the next one to be overwritten
+    const size_t oldest = totalRecords > CAPACITY ? nextRecord : 0;
+    for (size_t i = 0; i < recordCount; i++) {
+        file.write(reinterpret_cast<const char*>(&records[(oldest + i) % CAPACITY]), sizeof(EventTraceRecord));
+    }
+
+    if (!file) {
+        Logger::Err("Could not write event trace file " + filePath);
+        return false;
+    }
+    Logger::Log("Event trace written to " + filePath);
+    return true;
+}
+
+#endif
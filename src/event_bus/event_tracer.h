@@ -0,0 +1,145 @@
+#ifndef EVENT_TRACER_H
+#define EVENT_TRACER_H
+
+// Optional flight recorder for the event bus. Build with EVENT_TRACING defined
+// (cmake -DEVENT_TRACING=ON) to record every emit and handler call in a fixed
+// size ring buffer. Without it the class does not exist and the TRACE_ macros
+// expand to nothing, so a regular build pays nothing for it.
+
+#ifdef EVENT_TRACING
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+struct EventTraceRecord {
+    // SDL performance counter ticks
+    uint64_t timestamp;
+    // ticks spent in the handler, 0 for emits
+    uint32_t duration;
+    uint32_t frame;
+    // ids in the tracer's name table
+    uint16_t eventNameID;
+    uint16_t emitterNameID;
+    uint16_t handlerNameID;
+    uint16_t padding;
+};
+
+class EventTracer {
+public:
+    // handler id of the record written when an event is emitted
+    static constexpr uint16_t EMIT = 0;
+    // emitter id used outside of any TRACE_EVENT_EMITTER scope
+    static constexpr uint16_t UNKNOWN_EMITTER = 1;
+    static constexpr size_t CAPACITY = 1 << 16;
+
+    static uint64_t Now() {
+        return SDL_GetPerformanceCounter();
+    }
+
+    // name table id for a plain string, or for a demangled type name
+    static uint16_t Intern(const std::string& name);
+    static uint16_t InternType(const std::type_info& type);
+
+    template<typename TEvent>
+    static uint16_t GetEventNameID() {
+        static const uint16_t id = InternType(typeid(TEvent));
+        return id;
+    }
+
+    static void Record(const uint16_t eventNameID, const uint16_t handlerNameID, const uint64_t start,
+                       const uint64_t end) {
+        EventTraceRecord& record = records[nextRecord];
+        record.timestamp = start;
+        record.duration = static_cast<uint32_t>(end - start);
+        record.frame = frame;
+        record.eventNameID = eventNameID;
+        record.emitterNameID = currentEmitter;
+        record.handlerNameID = handlerNameID;
+        record.padding = 0;
+        nextRecord = (nextRecord + 1) % CAPACITY;
+        totalRecords++;
+    }
+
+    template<typename TEvent>
+    static void RecordEmit() {
+        const uint64_t now = Now();
+        Record(GetEventNameID<TEvent>(), EMIT, now, now);
+    }
+
+    static void NextFrame() {
+        frame++;
+    }
+
+    // per event type: emits, emits per frame and p50/p99 handler time, through the logger
+    static void LogSummary();
+
+    // writes the name table and the buffered records, oldest first, see event_tracer.cpp
+    static bool Dump(const std::string& filePath);
+
+    // names whoever emits events while it is alive
+    class EmitterScope {
+    private:
+        uint16_t previousEmitter;
+
+    public:
+        explicit EmitterScope(const uint16_t emitterNameID) : previousEmitter(currentEmitter) {
+            currentEmitter = emitterNameID;
+        }
+
+        ~EmitterScope() {
+            currentEmitter = previousEmitter;
+        }
+    };
+
+    // times the handling of one queued event, for consumers of event channels
+    class HandlerScope {
+    private:
+        uint16_t eventNameID;
+        uint16_t handlerNameID;
+        uint64_t start;
+
+    public:
+        HandlerScope(const uint16_t eventNameID, const uint16_t handlerNameID) : eventNameID(eventNameID),
+                                                                                 handlerNameID(handlerNameID),
+                                                                                 start(Now()) {
+        }
+
+        ~HandlerScope() {
+            Record(eventNameID, handlerNameID, start, Now());
+        }
+    };
+
+private:
+    static std::vector<std::string> names;
+    static std::vector<EventTraceRecord> records;
+    static size_t nextRecord;
+    static uint64_t totalRecords;
+    static uint32_t frame;
+    static uint16_t currentEmitter;
+};
+
+#define EVENT_TRACE_CONCAT_INNER(a, b) a##b
+#define EVENT_TRACE_CONCAT(a, b) EVENT_TRACE_CONCAT_INNER(a, b)
+
+#define TRACE_EVENT_FRAME() EventTracer::NextFrame()
+#define TRACE_EVENT_EMITTER(name)                                                          \
+    static const uint16_t EVENT_TRACE_CONCAT(eventTraceEmitter, __LINE__) = EventTracer::Intern(name); \
+    EventTracer::EmitterScope EVENT_TRACE_CONCAT(eventTraceEmitterScope, __LINE__)(                     \
+        EVENT_TRACE_CONCAT(eventTraceEmitter, __LINE__))
+#define TRACE_EVENT_HANDLER(TEvent, name)                                                  \
+    static const uint16_t EVENT_TRACE_CONCAT(eventTraceHandler, __LINE__) = EventTracer::Intern(name); \
+    EventTracer::HandlerScope EVENT_TRACE_CONCAT(eventTraceHandlerScope, __LINE__)(                     \
+        EventTracer::GetEventNameID<TEvent>(), EVENT_TRACE_CONCAT(eventTraceHandler, __LINE__))
+
+#else
+
+#define TRACE_EVENT_FRAME()
+#define TRACE_EVENT_EMITTER(name)
+#define TRACE_EVENT_HANDLER(TEvent, name)
+
+#endif
+
+#endif //EVENT_TRACER_H
@@ -4,15 +4,78 @@
 
 #ifndef COLLISION_EVENT_H
 #define COLLISION_EVENT_H
+#include <cstdint>
+#include <vector>
 #include "../event_bus/event.h"
 #include "../ecs/ecs.h"
 
+// Two colliders overlapping this frame, emitted every frame they do. Handlers
+// that should run once per contact read the enter/exit events below instead.
 class CollisionEvent: public Event {
 public:
     Entity a;
     Entity b;
+    // EntityLabels bits of a and b when the collision was detected
+    uint64_t aLabels;
+    uint64_t bLabels;
+    // fraction of the frame's move at which the boxes first touched, below 1
+    // only for fast movers caught by the swept test
+    float timeOfImpact;
 
-    CollisionEvent(const Entity a, const Entity b) : a(a), b(b) {
+    CollisionEvent(const Entity a, const Entity b, const float timeOfImpact = 1.0f) : a(a), b(b),
+        aLabels(a.GetLabels()), bLabels(b.GetLabels()), timeOfImpact(timeOfImpact) {
+    }
+
+    CollisionEvent(const Entity a, const Entity b, const uint64_t aLabels, const uint64_t bLabels,
+                   const float timeOfImpact = 1.0f) : a(a), b(b), aLabels(aLabels), bLabels(bLabels),
+                                                      timeOfImpact(timeOfImpact) {
+    }
+};
+
+// the first frame two colliders overlap
+class CollisionEnterEvent: public CollisionEvent {
+public:
+    using CollisionEvent::CollisionEvent;
+};
+
+// every later frame they keep overlapping, only emitted when the
+// BoxColliderSystem is asked to
+class CollisionStayEvent: public CollisionEvent {
+public:
+    using CollisionEvent::CollisionEvent;
+};
+
+// the first frame they stopped overlapping, a and b come in the same order as
+// in the enter event. Also sent when one of them was destroyed or disabled,
+// so check before touching their components; the labels are the ones they
+// had the last frame they touched.
+class CollisionExitEvent: public CollisionEvent {
+public:
+    using CollisionEvent::CollisionEvent;
+};
+
+// Precomputed "first has one of these labels and second one of those, in
+// either order" test, e.g. projectiles against enemies. Checking a pair is
+// two ANDs, no tag or group lookups.
+struct CollisionFilter {
+    uint64_t firstLabels;
+    uint64_t secondLabels;
+
+    CollisionFilter(const uint64_t firstLabels, const uint64_t secondLabels) : firstLabels(firstLabels),
+                                                                              secondLabels(secondLabels) {
+    }
+
+    // calls callback(first, second) for the matching collisions only, with the
+    // pair already swapped so first is the one matching firstLabels
+    template<typename TCollisionEvent, typename TCallback>
+    void ForEach(const std::vector<TCollisionEvent>& collisions, TCallback&& callback) const {
+        for (const auto& collision: collisions) {
+            if ((collision.aLabels & firstLabels) && (collision.bLabels & secondLabels)) {
+                callback(collision.a, collision.b);
+            } else if ((collision.bLabels & firstLabels) && (collision.aLabels & secondLabels)) {
+                callback(collision.b, collision.a);
+            }
+        }
     }
 };
 
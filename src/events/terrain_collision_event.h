@@ -0,0 +1,31 @@
+#ifndef TERRAIN_COLLISION_EVENT_H
+#define TERRAIN_COLLISION_EVENT_H
+
+#include <cstdint>
+#include "../collision/aabb.h"
+#include "../event_bus/event.h"
+#include "../ecs/ecs.h"
+
+// a collider overlapping a solid tile of the TileCollisionMap this frame,
+// emitted every frame it does
+class TerrainCollisionEvent: public Event {
+public:
+    Entity entity;
+    // EntityLabels bits of the entity when the collision was detected
+    uint64_t labels;
+    // the tile hit, the first one for fast movers
+    int column;
+    int row;
+    AABB tileBounds;
+    // fraction of the frame's move at which the collider reached the tile,
+    // below 1 only for fast movers
+    float timeOfImpact;
+
+    TerrainCollisionEvent(const Entity entity, const int column, const int row, const AABB& tileBounds,
+                          const float timeOfImpact = 1.0f) : entity(entity), labels(entity.GetLabels()),
+                                                             column(column), row(row), tileBounds(tileBounds),
+                                                             timeOfImpact(timeOfImpact) {
+    }
+};
+
+#endif //TERRAIN_COLLISION_EVENT_H
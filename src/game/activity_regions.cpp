@@ -0,0 +1,58 @@
+#include "activity_regions.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../timing/frame_clock.h"
+
+void ActivityRegions::Reset(const int mapWidth, const int mapHeight) {
+    columns = std::max(1, (mapWidth + cellSize - 1) / cellSize);
+    rows = std::max(1, (mapHeight + cellSize - 1) / cellSize);
+    lastUpdateSteps.assign(columns * rows, FrameClock::GetSteps());
+    elapsedSteps.assign(columns * rows, 0);
+    activeCellCount = 0;
+}
+
+void ActivityRegions::SetCellSize(const int pixels) {
+    cellSize = std::max(1, pixels);
+    inverseCellSize = 1.0f / cellSize;
+}
+
+void ActivityRegions::SetMargin(const int pixels) {
+    margin = std::max(0, pixels);
+}
+
+void ActivityRegions::SetSleepInterval(const int steps) {
+    sleepInterval = std::max(1, steps);
+}
+
+void ActivityRegions::SetEnabled(const bool isEnabled) {
+    this->isEnabled = isEnabled;
+}
+
+void ActivityRegions::Update(const SDL_Rect& camera) {
+    const uint64_t step = FrameClock::GetSteps();
+    // the cells touching the camera grown by the margin
+    const int firstColumn = std::max(0, static_cast<int>(std::floor(
+                                             static_cast<double>(camera.x - margin) / cellSize)));
+    const int firstRow = std::max(0, static_cast<int>(std::floor(static_cast<double>(camera.y - margin) / cellSize)));
+    const int lastColumn = std::min(columns - 1, (camera.x + camera.w + margin) / cellSize);
+    const int lastRow = std::min(rows - 1, (camera.y + camera.h + margin) / cellSize);
+
+    activeCellCount = 0;
+    for (int row = 0; row < rows; row++) {
+        const bool isRowActive = row >= firstRow && row <= lastRow;
+        for (int column = 0; column < columns; column++) {
+            const int index = row * columns + column;
+            const bool isActive = !isEnabled || (isRowActive && column >= firstColumn && column <= lastColumn);
+            activeCellCount += isActive;
+            // sleeping cells take turns, the index spreads them over the interval
+            if (isActive || (step + index) % sleepInterval == 0) {
+                elapsedSteps[index] = static_cast<int>(step - lastUpdateSteps[index]);
+                lastUpdateSteps[index] = step;
+            } else {
+                elapsedSteps[index] = 0;
+            }
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef ACTIVITY_REGIONS_H
+#define ACTIVITY_REGIONS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <SDL2/SDL.h>
+#include <glm/glm.hpp>
+
+// Splits the map into square cells and decides, once per simulation step,
+// which of them are simulated. Cells within the margin around the camera are
+// active and run every step. The others sleep and run once every
+// sleepInterval steps, staggered so they do not all wake on the same step.
+// Systems ask how many steps the cell of an entity covers this step: 0 means
+// skip the entity, more than 1 is the time it slept and must be made up for.
+// An entity takes the clock of the cell it is in, so one crossing cells while
+// asleep may gain or lose up to sleepInterval steps, it is off screen anyway.
+class ActivityRegions {
+private:
+    int cellSize = 256;
+    float inverseCellSize = 1.0f / 256;
+    int margin = 256;
+    int sleepInterval = 8;
+    int columns = 0;
+    int rows = 0;
+    bool isEnabled = true;
+    // index = row * columns + column, in FrameClock steps
+    std::vector<uint64_t> lastUpdateSteps;
+    std::vector<int> elapsedSteps;
+    int activeCellCount = 0;
+
+    // called per entity and step, so inline and without floor: clamping
+    // before the conversion keeps the truncation on non-negative values
+    int GetCellIndex(const glm::vec2 position) const {
+        const int column = static_cast<int>(std::clamp(position.x * inverseCellSize, 0.0f,
+                                                       static_cast<float>(columns - 1)));
+        const int row = static_cast<int>(std::clamp(position.y * inverseCellSize, 0.0f, static_cast<float>(rows - 1)));
+        return row * columns + column;
+    }
+
+public:
+    // sizes the grid for a map, every cell counts as updated now
+    void Reset(int mapWidth, int mapHeight);
+
+    void SetCellSize(int pixels);
+    // how far beyond the camera cells stay active, in pixels
+    void SetMargin(int pixels);
+    void SetSleepInterval(int steps);
+    // disabled, every entity runs every step
+    void SetEnabled(bool isEnabled);
+
+    // called at the start of every step, before the systems it drives
+    void Update(const SDL_Rect& camera);
+
+    // the steps the cell holding the position covers this step, positions off
+    // the map count as the closest cell
+    int GetElapsedSteps(const glm::vec2 position) const {
+        if (elapsedSteps.empty()) {
+            return 1;
+        }
+        return elapsedSteps[GetCellIndex(position)];
+    }
+
+    bool IsActive(glm::vec2 position) const {
+        return GetElapsedSteps(position) > 0;
+    }
+
+    int GetActiveCellCount() const {
+        return activeCellCount;
+    }
+
+    int GetCellCount() const {
+        return columns * rows;
+    }
+};
+
+#endif //ACTIVITY_REGIONS_H
@@ -16,8 +16,11 @@
 #include "../systems/box_collider_system.h"
 #include "../systems/camera_movement_system.h"
 #include "../systems/damage_system.h"
+#include "../systems/interpolation_system.h"
 #include "../systems/keyboard_control_system.h"
 #include "../systems/movement_system.h"
+#include "../systems/player_movement_system.h"
+#include "../systems/player_projectile_emit_system.h"
 #include "../systems/projectile_emit_system.h"
 #include "../systems/projectile_lifecycle_system.h"
 #include "../systems/render_collider_system.h"
@@ -26,6 +29,8 @@
 #include "../systems/render_system.h"
 #include "../systems/render_text_system.h"
 #include "../systems/script_system.h"
+#include "../systems/static_collider_system.h"
+#include "../timing/frame_clock.h"
 
 
 int Game::mapWidth     = 0;
@@ -36,13 +41,17 @@ int Game::windowHeight = 0;
 Game::Game() : isRunning(false),
                isDebug(false),
                isFreezed(false),
-               millisecondsPreviousFrame(0),
+               accumulatedSeconds(0),
+               secondsSinceTitleUpdate(0),
+               interpolationAlpha(1),
                camera(SDL_Rect{}),
+               previousCamera(SDL_Rect{}),
                window(nullptr),
                renderer(nullptr) {
     this->registry   = std::make_unique<Registry>();
     this->assetStore = std::make_unique<AssetStore>();
     this->eventBus   = std::make_unique<EventBus>();
+    this->workerPool = std::make_unique<WorkerPool>();
 
     Logger::Log("Game constructor");
 }
@@ -66,86 +75,156 @@ void Game::Setup() {
     this->registry->AddSystem<DamageSystem>();
     this->registry->AddSystem<RenderSystem>();
     this->registry->AddSystem<MovementSystem>();
+    this->registry->AddSystem<PlayerMovementSystem>();
     this->registry->AddSystem<AnimationSystem>();
     this->registry->AddSystem<RenderGUISystem>();
     this->registry->AddSystem<RenderTextSystem>();
     this->registry->AddSystem<BoxColliderSystem>();
+    this->registry->AddSystem<StaticColliderSystem>();
     this->registry->AddSystem<RenderColliderSystem>();
     this->registry->AddSystem<KeyboardControlSystem>();
     this->registry->AddSystem<CameraMovementSystem>();
     this->registry->AddSystem<ProjectileEmitSystem>();
+    this->registry->AddSystem<PlayerProjectileEmitSystem>();
     this->registry->AddSystem<RenderHeathBarSystem>();
     this->registry->AddSystem<ProjectileLifecycleSystem>();
     this->registry->AddSystem<ScriptSystem>();
+    this->registry->AddSystem<InterpolationSystem>();
+
+    // keep the hot component pools in spatial order, so neighbouring entities
+    // sit next to each other in memory and systems walk them front to back
+    this->registry->SortPoolByKey<TransformComponent>([](const Entity entity) {
+        const auto& position = entity.ReadComponent<TransformComponent>().position;
+        return MortonCode(
+            static_cast<uint32_t>(std::max(0.0f, position.x) / 32),
+            static_cast<uint32_t>(std::max(0.0f, position.y) / 32)
+        );
+    });
+    this->registry->SortPoolLike<RigidBodyComponent, TransformComponent>();
+    this->registry->SortPoolLike<SpriteComponent, TransformComponent>();
+    this->registry->SortPoolLike<BoxColliderComponent, TransformComponent>();
+    this->registry->IterateSystemsInPoolOrder<TransformComponent>();
+
+    // spatial queries are answered from the collision broadphase
+    this->registry->SetSpatialIndex(&registry->GetSystem<BoxColliderSystem>().GetSpatialIndex());
+
+    // subscriptions last until the systems drop their handles
+    registry->GetSystem<KeyboardControlSystem>().SubscribeToEvents(this->eventBus);
+    registry->GetSystem<PlayerProjectileEmitSystem>().SubscribeToEvents(this->eventBus);
+
+    this->registry->GetSystem<ScriptSystem>().CreateLuaBindings(lua, registry);
 
-    this->registry->GetSystem<ScriptSystem>().CreateLuaBindings(lua);
+    // before the level, its components take their start times from the clock
+    FrameClock::Reset(STEPS_PER_SECOND);
 
     lua.open_libraries(sol::lib::base, sol::lib::math, sol::lib::os);
     LevelLoader::LoadLevel(lua, registry, assetStore, renderer, 2);
+
+    // sized for the map the level just set
+    activityRegions.SetCellSize(ACTIVITY_CELL_SIZE);
+    activityRegions.SetMargin(ACTIVITY_MARGIN);
+    activityRegions.SetSleepInterval(ACTIVITY_SLEEP_INTERVAL);
+    activityRegions.Reset(mapWidth, mapHeight);
 }
 
 void Game::Update() {
-    // Wait until 16ms has elapsed since last frame
-    const int timeToWait =
-        MILLIS_PER_FRAME - (static_cast<int>(SDL_GetTicks()) - millisecondsPreviousFrame);
-    if (timeToWait > 0 && timeToWait <= MILLIS_PER_FRAME) {
-        SDL_Delay(timeToWait);
+    // wait until the frame is due, the only wait of the loop besides the vsync of the present
+    const double deltaTime = framePacer.WaitForNextFrame();
+    TRACE_EVENT_FRAME();
+
+    // run the steps the elapsed time pays for, the remainder carries over
+    accumulatedSeconds += deltaTime;
+    int steps = 0;
+    while (accumulatedSeconds >= SECONDS_PER_STEP && steps < MAX_STEPS_PER_FRAME) {
+        FixedUpdate(static_cast<float>(SECONDS_PER_STEP));
+        accumulatedSeconds -= SECONDS_PER_STEP;
+        steps++;
     }
+    if (accumulatedSeconds >= SECONDS_PER_STEP) {
+        // too far behind, the game slows down instead of freezing
+        accumulatedSeconds = std::fmod(accumulatedSeconds, SECONDS_PER_STEP);
+    }
+    interpolationAlpha = static_cast<float>(accumulatedSeconds / SECONDS_PER_STEP);
 
-    const float deltaTime = (static_cast<float>(SDL_GetTicks()) - static_cast<float>(millisecondsPreviousFrame)) /
-                            1000.0f;
-
-    millisecondsPreviousFrame = static_cast<int>(SDL_GetTicks());
-
-    // reset all event handlers for current frame
-    this->eventBus->Reset();
+    // *************************************************************************
+    // print FPS and how far the frames were from the paced interval, once a second
+    secondsSinceTitleUpdate += deltaTime;
+    if (secondsSinceTitleUpdate >= 1.0) {
+        secondsSinceTitleUpdate = 0;
+        double maxError, meanError;
+        framePacer.TakeErrorStats(maxError, meanError);
+        char buffer[80];
+        snprintf(buffer, sizeof(buffer), "FPS: %d, pacing error: %.2f ms mean, %.2f ms max",
+                 static_cast<int>(ceil(1.0 / deltaTime)), meanError * 1000, maxError * 1000);
+        SDL_SetWindowTitle(this->window, buffer);
+    }
+}
 
-    // perform the subscription of the events
-    registry->GetSystem<DamageSystem>().SubscribeToEvents(this->eventBus);
-    registry->GetSystem<KeyboardControlSystem>().SubscribeToEvents(this->eventBus);
-    registry->GetSystem<ProjectileEmitSystem>().SubscribeToEvents(this->eventBus);
-    registry->GetSystem<MovementSystem>().SubscribeToEvents(this->eventBus);
+// one step of the simulation, deltaTime is always SECONDS_PER_STEP
+void Game::FixedUpdate(const float deltaTime) {
+    FrameClock::Step();
 
     // update the registry to process the entities that are waiting to be created/destroyed
     registry->Update();
 
+    // the state rendering interpolates from
+    registry->GetSystem<InterpolationSystem>().SavePreviousPositions();
+    previousCamera = camera;
+
+    // which parts of the map run this step, from where the camera ended the last one
+    activityRegions.Update(camera);
+
     // Ask all systems to run
     if (!this->isFreezed) {
-        registry->GetSystem<MovementSystem>().Update(deltaTime);
+        registry->GetSystem<MovementSystem>().Update(this->registry, deltaTime, activityRegions, MotionBounds{
+            0, 0, static_cast<float>(mapWidth), static_cast<float>(mapHeight)
+        });
+        registry->GetSystem<PlayerMovementSystem>().Update(deltaTime);
     }
-    registry->GetSystem<AnimationSystem>().Update();
-    registry->GetSystem<BoxColliderSystem>().Update(this->eventBus);
-    registry->GetSystem<ProjectileEmitSystem>().Update(this->registry);
+    registry->GetSystem<AnimationSystem>().Update(activityRegions);
+    registry->GetSystem<BoxColliderSystem>().Update(
+        this->eventBus,
+        registry->GetSystem<StaticColliderSystem>(),
+        *this->workerPool
+    );
+    // publish this frame's collisions and let their consumers handle the batch
+    this->eventBus->SwapChannels();
+    registry->GetSystem<DamageSystem>().Update(this->eventBus);
+    registry->GetSystem<MovementSystem>().ProcessCollisions(this->eventBus);
+    registry->GetSystem<ProjectileEmitSystem>().Update(this->registry, activityRegions);
     registry->GetSystem<CameraMovementSystem>().Update(this->camera);
     registry->GetSystem<ProjectileLifecycleSystem>().Update();
-    registry->GetSystem<ScriptSystem>().Update(deltaTime, SDL_GetTicks());
-
-    // *************************************************************************
-    // print FPS
-    //    Logger::Log("FPS: " + std::to_string(1.0f / deltaTime));
-    char buffer[50];
-    snprintf(buffer, sizeof(buffer), "FPS: %d", static_cast<int>(ceil(1.0f / deltaTime)));
-    SDL_SetWindowTitle(this->window, buffer);
+    // scripts get the simulated time, so they replay the same way at any frame rate
+    registry->GetSystem<ScriptSystem>().Update(deltaTime, FrameClock::GetMilliseconds(), activityRegions);
 }
 
 void Game::Render() {
     SDL_SetRenderDrawColor(this->renderer, 21, 21, 21, 255);
     SDL_RenderClear(this->renderer);
 
+    // draw between the last two simulation steps, the camera included so
+    // entities following the player do not shake against it
+    SDL_Rect renderCamera = this->camera;
+    renderCamera.x = static_cast<int>(std::lround(
+        previousCamera.x + (camera.x - previousCamera.x) * static_cast<double>(interpolationAlpha)));
+    renderCamera.y = static_cast<int>(std::lround(
+        previousCamera.y + (camera.y - previousCamera.y) * static_cast<double>(interpolationAlpha)));
+
     // invoke all systems that need to render
-    registry->GetSystem<RenderSystem>().Update(this->renderer, this->assetStore, this->camera);
+    registry->GetSystem<RenderSystem>().Update(this->renderer, this->assetStore, renderCamera, interpolationAlpha);
     registry->GetSystem<RenderTextSystem>().Update(
         this->renderer,
         this->assetStore,
-        this->camera
+        renderCamera
     );
     registry->GetSystem<RenderHeathBarSystem>().Update(
         this->renderer,
         this->assetStore,
-        this->camera
+        renderCamera,
+        interpolationAlpha
     );
     if (this->isDebug) {
-        registry->GetSystem<RenderColliderSystem>().Update(this->renderer, this->camera);
+        registry->GetSystem<RenderColliderSystem>().Update(this->renderer, renderCamera, interpolationAlpha);
         registry->GetSystem<RenderGUISystem>().Update(registry, camera);
     }
 
@@ -207,6 +286,19 @@ void Game::Initialize() {
         return;
     }
 
+    // the present waits for vsync when the driver honours it, the pacer must not wait on top of it
+    SDL_RendererInfo rendererInfo;
+    const bool isVsyncEnabled = SDL_GetRendererInfo(renderer, &rendererInfo) == 0 &&
+                                (rendererInfo.flags & SDL_RENDERER_PRESENTVSYNC);
+    // the display the window ended up on, it may not be display 0
+    SDL_DisplayMode windowDisplayMode;
+    const int refreshRate = SDL_GetWindowDisplayMode(window, &windowDisplayMode) == 0
+                                ? windowDisplayMode.refresh_rate
+                                : displayMode.refresh_rate;
+    framePacer.SetTargetFps(FPS);
+    framePacer.SetVsync(isVsyncEnabled, refreshRate);
+    Logger::Log("Frame pacing at " + std::to_string(framePacer.GetEffectiveFps()) + " fps");
+
     // Initialize the ImGui context
     ImGui::CreateContext();
     ImGuiSDL::Initialize(renderer, windowWidth, windowHeight);
@@ -223,6 +315,7 @@ void Game::Initialize() {
 }
 
 void Game::ProcessInput() {
+    TRACE_EVENT_EMITTER("Game::ProcessInput");
     SDL_Event sdlEvent;
     while (SDL_PollEvent(&sdlEvent)) {
         // ImGui SDL Input
@@ -248,6 +341,14 @@ void Game::ProcessInput() {
                 if (sdlEvent.key.keysym.sym == SDLK_f) {
                     this->isFreezed = !this->isFreezed;
                 }
+#ifdef EVENT_TRACING
+                if (sdlEvent.key.keysym.sym == SDLK_F9) {
+                    EventTracer::LogSummary();
+                }
+                if (sdlEvent.key.keysym.sym == SDLK_F10) {
+                    EventTracer::Dump("event_trace.bin");
+                }
+#endif
                 break;
             default: ;
         }
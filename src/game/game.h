@@ -8,18 +8,41 @@
 #include "../ecs/ecs.h"
 #include "../asset_store/asset_store.h"
 #include "../event_bus/event_bus.h"
+#include "../jobs/worker_pool.h"
+#include "../timing/frame_pacer.h"
+#include "activity_regions.h"
 
-constexpr int FPS              = 120;
-constexpr int MILLIS_PER_FRAME = 1000 / FPS;
+// the frame rate the FramePacer aims for, vsync may round it to a fraction of the refresh rate
+constexpr int FPS = 120;
+
+// the simulation advances in steps of fixed length, whatever the frame rate
+constexpr int STEPS_PER_SECOND    = 60;
+constexpr double SECONDS_PER_STEP = 1.0 / STEPS_PER_SECOND;
+// a frame owing more steps drops the rest, otherwise a slow frame makes the
+// next one run more steps and slower still
+constexpr int MAX_STEPS_PER_FRAME = 5;
+
+// entities this far beyond the camera still run every step, further away they
+// sleep and run once every ACTIVITY_SLEEP_INTERVAL steps
+constexpr int ACTIVITY_CELL_SIZE      = 256;
+constexpr int ACTIVITY_MARGIN         = 256;
+constexpr int ACTIVITY_SLEEP_INTERVAL = 8;
 
 class Game {
     private:
         bool isRunning;
         bool isDebug;
         bool isFreezed;
-        int millisecondsPreviousFrame;
+        FramePacer framePacer;
+        ActivityRegions activityRegions;
+        // time not simulated yet, less than a step after Update
+        double accumulatedSeconds;
+        double secondsSinceTitleUpdate;
+        // how far the rendered frame is between the last two steps, 0 - 1
+        float interpolationAlpha;
 
         SDL_Rect camera;
+        SDL_Rect previousCamera;
         SDL_Window* window;
         SDL_Renderer* renderer;
 
@@ -28,6 +51,7 @@ class Game {
         std::unique_ptr<Registry> registry;
         std::unique_ptr<AssetStore> assetStore;
         std::unique_ptr<EventBus> eventBus;
+        std::unique_ptr<WorkerPool> workerPool;
 
     public:
         static int windowWidth;
@@ -43,6 +67,7 @@ class Game {
         void Setup();
         void ProcessInput();
         void Update();
+        void FixedUpdate(float deltaTime);
         void Render();
         void Destroy() const;
 };
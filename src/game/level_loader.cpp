@@ -10,6 +10,8 @@
 #include "../components/animation_component.h"
 #include "../components/box_collider_component.h"
 #include "../components/camera_component.h"
+#include "../components/collision_mask_component.h"
+#include "../components/fast_mover_component.h"
 #include "../components/health_component.h"
 #include "../components/keyword_controlled_component.h"
 #include "../components/projectile_emitter_component.h"
@@ -17,6 +19,7 @@
 #include "../components/script_component.h"
 #include "../components/sprite_component.h"
 #include "../components/transform_component.h"
+#include "../systems/box_collider_system.h"
 
 LevelLoader::LevelLoader() {}
 
@@ -80,6 +83,24 @@ void LevelLoader::LoadLevel(
     int mapNumCols = map["num_cols"];
     int tileSize = map["tile_size"];
     double mapScale = map["scale"];
+
+    // tiles listed in solid_tiles go into the terrain collision bit grid,
+    // a tile is named by its two digits in the map file
+    std::vector<bool> isSolidTile(100, false);
+    sol::optional<sol::table> solidTiles = map["solid_tiles"];
+    if (solidTiles != sol::nullopt) {
+        for (const auto& [key, value]: solidTiles.value()) {
+            const int tile = value.as<sol::optional<int>>().value_or(-1);
+            if (tile < 0 || tile >= static_cast<int>(isSolidTile.size())) {
+                Logger::Err("Invalid tile in solid_tiles, tiles are numbered 0 - 99");
+                continue;
+            }
+            isSolidTile[tile] = true;
+        }
+    }
+    auto& tileMap = registry->GetSystem<BoxColliderSystem>().GetTileMap();
+    tileMap.Reset(mapNumCols, mapNumRows, tileSize * mapScale);
+
     std::fstream mapFile;
     mapFile.open(mapFilePath);
     for (int y = 0; y < mapNumRows; y++) {
@@ -90,6 +111,8 @@ void LevelLoader::LoadLevel(
             mapFile.get(ch);
             int srcRectX = std::atoi(&ch) * tileSize;
             mapFile.ignore();
+            const int tileNumber = (srcRectY / tileSize) * 10 + srcRectX / tileSize;
+            tileMap.SetSolid(x, y, tileNumber >= 0 && tileNumber < 100 && isSolidTile[tileNumber]);
 
             Entity tile = registry->CreateEntity();
             tile.AddComponent<TransformComponent>(glm::vec2(x * (mapScale * tileSize), y * (mapScale * tileSize)), glm::vec2(mapScale, mapScale), 0.0);
@@ -100,6 +123,24 @@ void LevelLoader::LoadLevel(
     Game::mapWidth = mapNumCols * tileSize * mapScale;
     Game::mapHeight = mapNumRows * tileSize * mapScale;
 
+    ////////////////////////////////////////////////////////////////////////////
+    // Read the collision layer pairs that never collide
+    ////////////////////////////////////////////////////////////////////////////
+    sol::optional<sol::table> ignoredLayerPairs = level["ignored_collision_layer_pairs"];
+    if (ignoredLayerPairs != sol::nullopt) {
+        auto& layerMatrix = registry->GetSystem<BoxColliderSystem>().GetLayerMatrix();
+        for (const auto& [key, value]: ignoredLayerPairs.value()) {
+            sol::table layerPair = value;
+            const int a = layerPair[1].get_or(-1);
+            const int b = layerPair[2].get_or(-1);
+            if (a < 0 || a >= MAX_COLLISION_LAYERS || b < 0 || b >= MAX_COLLISION_LAYERS) {
+                Logger::Err("Invalid collision layer pair in ignored_collision_layer_pairs");
+                continue;
+            }
+            layerMatrix.SetLayersCollide(a, b, false);
+        }
+    }
+
     ////////////////////////////////////////////////////////////////////////////
     // Read the level entities and their components
     ////////////////////////////////////////////////////////////////////////////
@@ -183,13 +224,42 @@ void LevelLoader::LoadLevel(
             // BoxCollider
             sol::optional<sol::table> collider = entity["components"]["boxcollider"];
             if (collider != sol::nullopt) {
+                int layer = entity["components"]["boxcollider"]["layer"].get_or(COLLISION_LAYER_DEFAULT);
+                if (layer < 0 || layer >= MAX_COLLISION_LAYERS) {
+                    Logger::Err("Collision layer " + std::to_string(layer) + " out of range, using the default layer");
+                    layer = COLLISION_LAYER_DEFAULT;
+                }
                 newEntity.AddComponent<BoxColliderComponent>(
                     entity["components"]["boxcollider"]["width"],
                     entity["components"]["boxcollider"]["height"],
                     glm::vec2(
                         entity["components"]["boxcollider"]["offset"]["x"].get_or(0),
                         entity["components"]["boxcollider"]["offset"]["y"].get_or(0)
-                    )
+                    ),
+                    layer,
+                    static_cast<uint32_t>(entity["components"]["boxcollider"]["mask"].get_or(
+                        static_cast<long long>(ALL_COLLISION_LAYERS)))
+                );
+
+                // pixel perfect, the masks come from the frames of the sprite above
+                if (entity["components"]["boxcollider"]["pixel_perfect"].get_or(false)) {
+                    if (newEntity.HasComponent<SpriteComponent>()) {
+                        const auto& spriteComponent = newEntity.ReadComponent<SpriteComponent>();
+                        newEntity.AddComponent<CollisionMaskComponent>(assetStore->GetSpriteMasks(
+                            spriteComponent.textureAssetID, spriteComponent.width, spriteComponent.height));
+                    } else {
+                        Logger::Err("pixel_perfect needs a sprite, using the box only");
+                    }
+                }
+            }
+
+            // FastMover, swept from where the entity spawns
+            sol::optional<sol::table> fastMover = entity["components"]["fast_mover"];
+            if (fastMover != sol::nullopt) {
+                newEntity.AddComponent<FastMoverComponent>(
+                    newEntity.HasComponent<TransformComponent>()
+                        ? newEntity.ReadComponent<TransformComponent>().position
+                        : glm::vec2(0)
                 );
             }
 
@@ -0,0 +1,92 @@
+#include "worker_pool.h"
+
+#include <algorithm>
+
+#include "../logger/logger.h"
+
+WorkerPool::WorkerPool(int threadCount) {
+    if (threadCount <= 0) {
+        threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    for (int i = 1; i < threadCount; i++) {
+        workers.emplace_back(&WorkerPool::WorkerLoop, this);
+    }
+    Logger::Log("Worker pool created with " + std::to_string(threadCount) + " threads");
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isStopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& worker: workers) {
+        worker.join();
+    }
+}
+
+void WorkerPool::RunTasks(const std::function<void(int task)>& function, const int count) {
+    for (int i = nextTask.fetch_add(1, std::memory_order_relaxed); i < count;
+         i = nextTask.fetch_add(1, std::memory_order_relaxed)) {
+        function(i);
+    }
+}
+
+void WorkerPool::WorkerLoop() {
+    unsigned int seenGeneration = 0;
+    while (true) {
+        const std::function<void(int task)>* function;
+        int count;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workAvailable.wait(lock, [&] {
+                // task is null between loops, a late wake up has nothing to join
+                return isStopping || (task && generation != seenGeneration);
+            });
+            if (isStopping) {
+                return;
+            }
+            seenGeneration = generation;
+            function = task;
+            count = taskCount;
+            busyWorkers++;
+        }
+        RunTasks(*function, count);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            busyWorkers--;
+        }
+        workDone.notify_one();
+    }
+}
+
+void WorkerPool::ParallelFor(const int count, const std::function<void(int task)>& function) {
+    if (count <= 0) {
+        return;
+    }
+    // nothing to share, skip the wake up
+    if (count == 1 || workers.empty()) {
+        for (int i = 0; i < count; i++) {
+            function(i);
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &function;
+        taskCount = count;
+        nextTask.store(0, std::memory_order_relaxed);
+        generation++;
+    }
+    workAvailable.notify_all();
+    RunTasks(function, count);
+
+    // every task has been claimed, wait for the workers still running one.
+    // Clearing the function under the same lock keeps workers waking up late
+    // from picking it up after it went out of scope.
+    std::unique_lock<std::mutex> lock(mutex);
+    workDone.wait(lock, [&] {
+        return busyWorkers == 0;
+    });
+    task = nullptr;
+}
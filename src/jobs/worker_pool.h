@@ -0,0 +1,52 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data parallel loops. ParallelFor hands out
+// task indices from a shared counter to the workers and to the calling
+// thread, and returns once every task is done. Tasks must not touch the
+// registry or the event bus, they are main thread only: read the inputs
+// gathered beforehand and write to buffers owned by the task.
+class WorkerPool {
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable workDone;
+
+    // the loop being run, guarded by mutex except for nextTask
+    const std::function<void(int task)>* task = nullptr;
+    int taskCount = 0;
+    std::atomic<int> nextTask{0};
+    // bumped for every ParallelFor, wakes the workers exactly once per loop
+    unsigned int generation = 0;
+    int busyWorkers = 0;
+    bool isStopping = false;
+
+    void WorkerLoop();
+    void RunTasks(const std::function<void(int task)>& function, int count);
+
+public:
+    // threadCount includes the calling thread, 0 picks one per hardware thread
+    explicit WorkerPool(int threadCount = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator =(const WorkerPool&) = delete;
+
+    int GetThreadCount() const {
+        return static_cast<int>(workers.size()) + 1;
+    }
+
+    // calls function(task) for every task in [0, count), in no particular
+    // order and possibly at the same time
+    void ParallelFor(int count, const std::function<void(int task)>& function);
+};
+
+#endif //WORKER_POOL_H
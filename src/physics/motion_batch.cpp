@@ -0,0 +1,124 @@
+#include "motion_batch.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MOTION_BATCH_SSE2
+#include <emmintrin.h>
+#endif
+
+// AVX2 is not part of the baseline flags, see aabb_batch.cpp
+#if defined(MOTION_BATCH_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define MOTION_BATCH_AVX2
+#include <immintrin.h>
+#endif
+
+void IntegrateMotionScalar(
+    MotionArrays& motion,
+    const float deltaTime,
+    const MotionBounds& bounds,
+    const int first,
+    std::vector<int>& outOfBounds
+) {
+    const int count = motion.GetSize();
+    for (int i = first; i < count; i++) {
+        const float x = motion.x[i] + motion.velocityX[i] * deltaTime;
+        const float y = motion.y[i] + motion.velocityY[i] * deltaTime;
+        motion.x[i] = x;
+        motion.y[i] = y;
+        if (x < bounds.minX || x > bounds.maxX || y < bounds.minY || y > bounds.maxY) {
+            outOfBounds.push_back(i);
+        }
+    }
+}
+
+#ifdef MOTION_BATCH_SSE2
+static void IntegrateMotionSSE2(
+    MotionArrays& motion,
+    const float deltaTime,
+    const MotionBounds& bounds,
+    std::vector<int>& outOfBounds
+) {
+    float* x = motion.x.data();
+    float* y = motion.y.data();
+    const float* velocityX = motion.velocityX.data();
+    const float* velocityY = motion.velocityY.data();
+    const __m128 dt = _mm_set1_ps(deltaTime);
+    const __m128 minX = _mm_set1_ps(bounds.minX);
+    const __m128 minY = _mm_set1_ps(bounds.minY);
+    const __m128 maxX = _mm_set1_ps(bounds.maxX);
+    const __m128 maxY = _mm_set1_ps(bounds.maxY);
+    const int count = motion.GetSize();
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 newX = _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(_mm_loadu_ps(velocityX + i), dt));
+        const __m128 newY = _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(_mm_loadu_ps(velocityY + i), dt));
+        _mm_storeu_ps(x + i, newX);
+        _mm_storeu_ps(y + i, newY);
+        const __m128 isOut = _mm_or_ps(
+            _mm_or_ps(_mm_cmplt_ps(newX, minX), _mm_cmpgt_ps(newX, maxX)),
+            _mm_or_ps(_mm_cmplt_ps(newY, minY), _mm_cmpgt_ps(newY, maxY)));
+        // almost always 0, the lanes are only looked at when something left the map
+        const int mask = _mm_movemask_ps(isOut);
+        for (int lane = 0; mask >> lane; lane++) {
+            if (mask & (1 << lane)) {
+                outOfBounds.push_back(i + lane);
+            }
+        }
+    }
+    IntegrateMotionScalar(motion, deltaTime, bounds, i, outOfBounds);
+}
+#endif
+
+#ifdef MOTION_BATCH_AVX2
+__attribute__((target("avx2")))
+static void IntegrateMotionAVX2(
+    MotionArrays& motion,
+    const float deltaTime,
+    const MotionBounds& bounds,
+    std::vector<int>& outOfBounds
+) {
+    float* x = motion.x.data();
+    float* y = motion.y.data();
+    const float* velocityX = motion.velocityX.data();
+    const float* velocityY = motion.velocityY.data();
+    const __m256 dt = _mm256_set1_ps(deltaTime);
+    const __m256 minX = _mm256_set1_ps(bounds.minX);
+    const __m256 minY = _mm256_set1_ps(bounds.minY);
+    const __m256 maxX = _mm256_set1_ps(bounds.maxX);
+    const __m256 maxY = _mm256_set1_ps(bounds.maxY);
+    const int count = motion.GetSize();
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // no FMA, the rounding stays the same as the scalar version
+        const __m256 newX = _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_mul_ps(_mm256_loadu_ps(velocityX + i), dt));
+        const __m256 newY = _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(_mm256_loadu_ps(velocityY + i), dt));
+        _mm256_storeu_ps(x + i, newX);
+        _mm256_storeu_ps(y + i, newY);
+        const __m256 isOut = _mm256_or_ps(
+            _mm256_or_ps(_mm256_cmp_ps(newX, minX, _CMP_LT_OQ), _mm256_cmp_ps(newX, maxX, _CMP_GT_OQ)),
+            _mm256_or_ps(_mm256_cmp_ps(newY, minY, _CMP_LT_OQ), _mm256_cmp_ps(newY, maxY, _CMP_GT_OQ)));
+        const int mask = _mm256_movemask_ps(isOut);
+        for (int lane = 0; mask >> lane; lane++) {
+            if (mask & (1 << lane)) {
+                outOfBounds.push_back(i + lane);
+            }
+        }
+    }
+    IntegrateMotionScalar(motion, deltaTime, bounds, i, outOfBounds);
+}
+#endif
+
+void IntegrateMotion(MotionArrays& motion, const float deltaTime, const MotionBounds& bounds,
+                     std::vector<int>& outOfBounds) {
+#if defined(MOTION_BATCH_AVX2)
+    static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+    if (hasAVX2) {
+        IntegrateMotionAVX2(motion, deltaTime, bounds, outOfBounds);
+        return;
+    }
+#endif
+#if defined(MOTION_BATCH_SSE2)
+    IntegrateMotionSSE2(motion, deltaTime, bounds, outOfBounds);
+#else
+    IntegrateMotionScalar(motion, deltaTime, bounds, 0, outOfBounds);
+#endif
+}
@@ -0,0 +1,55 @@
+#ifndef MOTION_BATCH_H
+#define MOTION_BATCH_H
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Positions and velocities as a structure of arrays, index = body. Gathered
+// from the transform and rigid body pools so the integration runs 4 (SSE2) or
+// 8 (AVX2) bodies per instruction.
+struct MotionArrays {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> velocityX;
+    std::vector<float> velocityY;
+
+    // sized once and filled with Set, four push_backs per body cost more than the integration
+    void Resize(const int count) {
+        x.resize(count);
+        y.resize(count);
+        velocityX.resize(count);
+        velocityY.resize(count);
+    }
+
+    void Set(const int index, const glm::vec2 position, const glm::vec2 velocity) {
+        x[index] = position.x;
+        y[index] = position.y;
+        velocityX[index] = velocity.x;
+        velocityY[index] = velocity.y;
+    }
+
+    int GetSize() const {
+        return static_cast<int>(x.size());
+    }
+};
+
+// bodies outside [minX, maxX] x [minY, maxY] are out of bounds
+struct MotionBounds {
+    float minX;
+    float minY;
+    float maxX;
+    float maxY;
+};
+
+// Moves every body by velocity * deltaTime and appends the index of the ones
+// that end up out of bounds to outOfBounds, in index order. Same float math as
+// position += velocity * deltaTime, so the results match the per entity loop.
+void IntegrateMotion(MotionArrays& motion, float deltaTime, const MotionBounds& bounds,
+                     std::vector<int>& outOfBounds);
+
+// the plain C++ version, also used for the leftover bodies of the SIMD versions
+void IntegrateMotionScalar(MotionArrays& motion, float deltaTime, const MotionBounds& bounds, int first,
+                           std::vector<int>& outOfBounds);
+
+#endif //MOTION_BATCH_H
@@ -10,6 +10,9 @@
 #include "../ecs/ecs.h"
 #include "../components/animation_component.h"
 #include "../components/sprite_component.h"
+#include "../components/transform_component.h"
+#include "../game/activity_regions.h"
+#include "../timing/frame_clock.h"
 
 class AnimationSystem : public System {
 public:
@@ -18,16 +21,30 @@ public:
         RequireComponent<AnimationComponent>();
     }
 
-    void Update() const {
+    // sprites in sleeping cells keep their frame, the frame is picked from the
+    // absolute time so they show the right one as soon as their cell runs again
+    void Update(const ActivityRegions& regions) const {
+        const int now = FrameClock::GetMilliseconds();
         for (auto entity: GetEntities()) {
-            auto& animationComponent = entity.GetComponent<AnimationComponent>();
-            auto& spriteComponent = entity.GetComponent<SpriteComponent>();
+            const auto& animationComponent = entity.ReadComponent<AnimationComponent>();
+            const auto& spriteComponent = entity.ReadComponent<SpriteComponent>();
+            if (!spriteComponent.isFixed && entity.HasComponent<TransformComponent>() &&
+                !regions.IsActive(entity.ReadComponent<TransformComponent>().position)) {
+                continue;
+            }
 
-            animationComponent.currentFrame =
-                    ((static_cast<int>(SDL_GetTicks()) - animationComponent.startTime) * animationComponent.
+            const int currentFrame =
+                    ((now - animationComponent.startTime) * animationComponent.
                      frameRateSpeed / 1000) %
                     animationComponent.numFrames;
-            spriteComponent.srcRect.x = spriteComponent.width * animationComponent.currentFrame;
+            // only a new frame is a change, snapshots skip untouched pools
+            const int srcRectX = spriteComponent.width * currentFrame;
+            if (currentFrame != animationComponent.currentFrame) {
+                entity.GetComponent<AnimationComponent>().currentFrame = currentFrame;
+            }
+            if (srcRectX != spriteComponent.srcRect.x) {
+                entity.GetComponent<SpriteComponent>().srcRect.x = srcRectX;
+            }
         }
     }
 };
@@ -5,55 +5,323 @@
 #ifndef BOX_COLLIDER_SYSTEM_H
 #define BOX_COLLIDER_SYSTEM_H
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "../collision/aabb_batch.h"
+#include "../collision/contact_cache.h"
+#include "../collision/pixel_mask.h"
+#include "../collision/spatial_index.h"
+#include "../collision/tile_collision_map.h"
+#include "../collision/uniform_grid.h"
 #include "../components/transform_component.h"
 #include "../components/box_collider_component.h"
+#include "../components/fast_mover_component.h"
+#include "../components/rigid_body_component.h"
 #include "../ecs/ecs.h"
 #include "../event_bus/event_bus.h"
 #include "../events/collision_event.h"
+#include "../events/terrain_collision_event.h"
+#include "../jobs/worker_pool.h"
+#include "static_collider_system.h"
 
+// Detects collisions of moving colliders (the ones with a RigidBodyComponent)
+// against each other and against the StaticColliderSystem's grid. Two static
+// colliders never start overlapping, so those pairs are not tested at all.
+// Colliders with a FastMoverComponent are swept from their previous position
+// to the current one: the grid gets the box covering the whole move and their
+// candidates go through AABB::Sweep instead of the overlap test, so they hit
+// thin colliders they would otherwise jump over.
+// Crowded scenes are split into ranges of the entity list searched on the
+// worker pool. Each range writes its contacts to its own buffers and those
+// are emitted range by range afterwards, so the events and their order are
+// the same whatever the number of threads.
+// Besides the CollisionEvent of every overlapping pair, the pairs are kept in
+// a ContactCache between frames to emit CollisionEnterEvent and
+// CollisionExitEvent (and CollisionStayEvent when enabled) as contacts start
+// and end. The grids are also handed to a SpatialIndex, which answers the
+// registry's spatial queries until the next frame. Terrain is not made of
+// colliders, moving colliders are checked against the TileCollisionMap and
+// reported as TerrainCollisionEvent.
+// Colliders with a CollisionMaskComponent only collide where their opaque
+// pixels touch: after the boxes overlap, the sprite masks (or the mask and the
+// other box) are compared too. Swept contacts and terrain keep the box.
 class BoxColliderSystem : public System {
+private:
+    // below this many colliders the whole search runs on the calling thread
+    static constexpr int MIN_PARALLEL_COLLIDERS = 1024;
+    static constexpr int MIN_COLLIDERS_PER_RANGE = 256;
+    // ranges per thread, some ranges have many more pairs than others
+    static constexpr int RANGES_PER_THREAD = 4;
+
+    // a collision found by a worker, b indexes the static grid for static contacts
+    struct Contact {
+        int a;
+        int b;
+        float timeOfImpact;
+    };
+
+    struct TerrainContact {
+        int a;
+        int column;
+        int row;
+        float timeOfImpact;
+    };
+
+    // what one range of the entity list found, plus its scratch buffers
+    struct ContactBuffers {
+        std::vector<std::pair<int, int>> candidates;
+        std::vector<std::pair<int, int>> discreteCandidates;
+        std::vector<std::pair<int, int>> overlapping;
+        std::vector<Contact> sweptContacts;
+        std::vector<Contact> staticContacts;
+        std::vector<TerrainContact> terrainContacts;
+    };
+
+    UniformGrid grid;
+    CollisionLayerMatrix layerMatrix;
+    // per frame buffers, index = position in the entity list
+    std::vector<Entity> colliderEntities;
+    std::vector<AABB> bounds;
+    // the box at the start of the move and the box covering the whole move,
+    // both equal to bounds for colliders that are not fast movers
+    std::vector<AABB> startBounds;
+    std::vector<AABB> sweptBounds;
+    std::vector<glm::dvec2> displacements;
+    std::vector<bool> isFastMover;
+    // the current bounds as floats in structure of arrays form, for the batched narrowphase
+    AABBArrays boxes;
+    std::vector<LayerFilter> filters;
+    // no mask for colliders without a CollisionMaskComponent
+    std::vector<PlacedMask> masks;
+    bool hasMasks = false;
+    // index = range, kept between frames so they stop allocating
+    std::vector<ContactBuffers> rangeContacts;
+    ContactCache contactCache;
+    bool emitsStayEvents = false;
+    SpatialIndex spatialIndex;
+    TileCollisionMap tileMap;
+
+    // the narrowphase of two boxes already known to overlap
+    static bool MasksOverlap(const PlacedMask& aMask, const AABB& aBox, const PlacedMask& bMask, const AABB& bBox) {
+        if (aMask.mask && bMask.mask) {
+            return PlacedMask::Overlaps(aMask, bMask);
+        }
+        if (aMask.mask) {
+            return PlacedMask::Overlaps(aMask, bBox);
+        }
+        if (bMask.mask) {
+            return PlacedMask::Overlaps(bMask, aBox);
+        }
+        return true;
+    }
+
+    // every collision of the colliders first .. last - 1, against the ones
+    // after them in the list and against the static grid
+    void FindContacts(const int first, const int last, const StaticColliderSystem& staticColliders,
+                      ContactBuffers& contacts) const {
+        const UniformGrid& staticGrid = staticColliders.GetGrid();
+        contacts.candidates.clear();
+        grid.FindPairs(first, last, contacts.candidates);
+        contacts.discreteCandidates.clear();
+        contacts.sweptContacts.clear();
+        for (const auto& [i, j]: contacts.candidates) {
+            if (!isFastMover[i] && !isFastMover[j]) {
+                contacts.discreteCandidates.emplace_back(i, j);
+                continue;
+            }
+            double timeOfImpact;
+            if (AABB::Sweep(startBounds[i], displacements[i].x, displacements[i].y,
+                            startBounds[j], displacements[j].x, displacements[j].y, timeOfImpact)) {
+                contacts.sweptContacts.push_back({i, j, static_cast<float>(timeOfImpact)});
+            }
+        }
+        contacts.overlapping.clear();
+        FindOverlappingPairs(boxes, contacts.discreteCandidates, contacts.overlapping);
+        if (hasMasks) {
+            contacts.overlapping.erase(
+                std::remove_if(contacts.overlapping.begin(), contacts.overlapping.end(), [&](const auto& pair) {
+                    return !MasksOverlap(masks[pair.first], bounds[pair.first], masks[pair.second], bounds[pair.second]);
+                }),
+                contacts.overlapping.end()
+            );
+        }
+
+        contacts.staticContacts.clear();
+        const bool hasStaticMasks = staticColliders.HasMasks();
+        const auto& staticMasks = staticColliders.GetMasks();
+        for (int i = first; i < last; i++) {
+            if (!isFastMover[i]) {
+                staticGrid.Query(bounds[i], filters[i], [&](const int staticIndex) {
+                    if ((hasMasks || hasStaticMasks) &&
+                        !MasksOverlap(masks[i], bounds[i], staticMasks[staticIndex], staticGrid.GetBounds(staticIndex))) {
+                        return;
+                    }
+                    contacts.staticContacts.push_back({i, staticIndex, 1.0f});
+                });
+                continue;
+            }
+            staticGrid.Query(sweptBounds[i], filters[i], [&](const int staticIndex) {
+                double timeOfImpact;
+                if (AABB::Sweep(startBounds[i], displacements[i].x, displacements[i].y,
+                                staticGrid.GetBounds(staticIndex), 0, 0, timeOfImpact)) {
+                    contacts.staticContacts.push_back({i, staticIndex, static_cast<float>(timeOfImpact)});
+                }
+            });
+        }
+
+        contacts.terrainContacts.clear();
+        if (!tileMap.HasSolidTiles()) {
+            return;
+        }
+        for (int i = first; i < last; i++) {
+            if (!LayerFilter::Accepts(filters[i], tileMap.GetFilter())) {
+                continue;
+            }
+            int column, row;
+            double timeOfImpact = 1;
+            const bool isHit = isFastMover[i]
+                ? tileMap.Sweep(startBounds[i], displacements[i].x, displacements[i].y, timeOfImpact, column, row)
+                : tileMap.FindOverlap(bounds[i], column, row);
+            if (isHit) {
+                contacts.terrainContacts.push_back({i, column, row, static_cast<float>(timeOfImpact)});
+            }
+        }
+    }
+
 public:
     BoxColliderSystem() {
         RequireComponent<BoxColliderComponent>();
         RequireComponent<TransformComponent>();
+        RequireComponent<RigidBodyComponent>();
+        // bullets fly through each other
+        layerMatrix.SetLayersCollide(COLLISION_LAYER_PROJECTILES, COLLISION_LAYER_PROJECTILES, false);
     }
 
-    void Update(const std::unique_ptr<EventBus>& eventBus) const {
-        auto entities = GetEntities();
-        for (auto i = entities.begin(); i != entities.end(); ++i) {
-            Entity entity = *i;
-            const auto& aTransform = entity.GetComponent<TransformComponent>();
-            const auto& aCollider = entity.GetComponent<BoxColliderComponent>();
-            for (auto j = i; j != entities.end(); ++j) {
-                Entity otherEntity = *j;
-                if (entity == otherEntity) {
-                    continue;
-                }
-                const auto otherTransform = otherEntity.GetComponent<TransformComponent>();
-                const auto otherCollider = otherEntity.GetComponent<BoxColliderComponent>();
-
-                if (CheckAABBCollision(
-                    aTransform.position.x + aCollider.offset.x,
-                    aTransform.position.y + aCollider.offset.y,
-                    aCollider.width,
-                    aCollider.height,
-                    otherTransform.position.x + otherCollider.offset.x,
-                    otherTransform.position.y + otherCollider.offset.y,
-                    otherCollider.width,
-                    otherCollider.height
-                )) {
-                    // emit event
-                    eventBus->EmitEvent<CollisionEvent>(entity, otherEntity);
-                }
+    CollisionLayerMatrix& GetLayerMatrix() {
+        return layerMatrix;
+    }
+
+    // filled by the level loader
+    TileCollisionMap& GetTileMap() {
+        return tileMap;
+    }
+
+    // register it with Registry::SetSpatialIndex
+    const SpatialIndex& GetSpatialIndex() const {
+        return spatialIndex;
+    }
+
+    // off by default, CollisionEvent already covers every frame of a contact
+    void SetEmitsStayEvents(const bool emitsStayEvents) {
+        this->emitsStayEvents = emitsStayEvents;
+    }
+
+    void Update(const std::unique_ptr<EventBus>& eventBus, StaticColliderSystem& staticColliders, WorkerPool& workers) {
+        TRACE_EVENT_EMITTER("BoxColliderSystem");
+        auto& collisions = eventBus->GetChannel<CollisionEvent>();
+        auto& collisionEnters = eventBus->GetChannel<CollisionEnterEvent>();
+        auto& collisionStays = eventBus->GetChannel<CollisionStayEvent>();
+        auto& collisionExits = eventBus->GetChannel<CollisionExitEvent>();
+        auto& terrainCollisions = eventBus->GetChannel<TerrainCollisionEvent>();
+        colliderEntities = GetEntities();
+        const auto& entities = colliderEntities;
+
+        bounds.clear();
+        startBounds.clear();
+        sweptBounds.clear();
+        displacements.clear();
+        isFastMover.clear();
+        boxes.Clear();
+        filters.clear();
+        masks.clear();
+        hasMasks = false;
+        for (auto entity: entities) {
+            const auto& transform = entity.ReadComponent<TransformComponent>();
+            const auto& collider = entity.ReadComponent<BoxColliderComponent>();
+            const AABB box = AABB::FromCollider(transform, collider);
+            bounds.push_back(box);
+            boxes.Add(box);
+            filters.push_back(layerMatrix.GetFilter(collider));
+            masks.push_back(StaticColliderSystem::GetPlacedMask(entity, transform));
+            hasMasks = hasMasks || masks.back().mask;
+
+            glm::dvec2 displacement(0);
+            if (entity.HasComponent<FastMoverComponent>()) {
+                auto& fastMover = entity.GetComponent<FastMoverComponent>();
+                displacement = glm::dvec2(transform.position) - glm::dvec2(fastMover.previousPosition);
+                fastMover.previousPosition = transform.position;
             }
+            const AABB startBox = box.Translated(-displacement.x, -displacement.y);
+            startBounds.push_back(startBox);
+            sweptBounds.push_back(AABB::Union(startBox, box));
+            displacements.push_back(displacement);
+            isFastMover.push_back(displacement != glm::dvec2(0));
         }
-    }
 
-    static bool CheckAABBCollision(
-        const double aX, const double aY, const int aWidth, const int aHeight,
-        const double bX, const double bY, const int bWidth, const int bHeight
-    ) {
-        return aX < bX + bWidth && aX + aWidth > bX && aY < bY + bHeight && aY + aHeight > bY;
+        // the grid only hands out pairs sharing a cell and accepting each
+        // other's layers, each of them once and in entity list order. The
+        // static grid is only rebuilt when needed, and before the workers start.
+        grid.Build(sweptBounds, filters);
+        staticColliders.Update();
+        const UniformGrid& staticGrid = staticColliders.GetGrid();
+
+        const int colliderCount = static_cast<int>(entities.size());
+        int rangeCount = 1;
+        if (colliderCount >= MIN_PARALLEL_COLLIDERS) {
+            rangeCount = std::min(workers.GetThreadCount() * RANGES_PER_THREAD,
+                                  colliderCount / MIN_COLLIDERS_PER_RANGE);
+        }
+        if (static_cast<int>(rangeContacts.size()) < rangeCount) {
+            rangeContacts.resize(rangeCount);
+        }
+        workers.ParallelFor(rangeCount, [&](const int range) {
+            FindContacts(
+                static_cast<int>(static_cast<long long>(colliderCount) * range / rangeCount),
+                static_cast<int>(static_cast<long long>(colliderCount) * (range + 1) / rangeCount),
+                staticColliders,
+                rangeContacts[range]
+            );
+        });
+
+        // queue the events, consumers read the batch once detection is done
+        contactCache.BeginFrame();
+        const auto emit = [&](const Entity a, const Entity b, const float timeOfImpact) {
+            const CollisionEvent& collision = collisions.Emit(a, b, timeOfImpact);
+            if (!contactCache.Add(collision.a, collision.b, collision.aLabels, collision.bLabels)) {
+                collisionEnters.Emit(collision.a, collision.b, collision.aLabels, collision.bLabels, timeOfImpact);
+            } else if (emitsStayEvents) {
+                collisionStays.Emit(collision.a, collision.b, collision.aLabels, collision.bLabels, timeOfImpact);
+            }
+        };
+        for (int range = 0; range < rangeCount; range++) {
+            for (const auto& [i, j]: rangeContacts[range].overlapping) {
+                emit(entities[i], entities[j], 1.0f);
+            }
+        }
+        for (int range = 0; range < rangeCount; range++) {
+            for (const auto& contact: rangeContacts[range].sweptContacts) {
+                emit(entities[contact.a], entities[contact.b], contact.timeOfImpact);
+            }
+        }
+        for (int range = 0; range < rangeCount; range++) {
+            for (const auto& contact: rangeContacts[range].staticContacts) {
+                emit(entities[contact.a], staticColliders.GetEntity(contact.b), contact.timeOfImpact);
+            }
+        }
+        for (int range = 0; range < rangeCount; range++) {
+            for (const auto& contact: rangeContacts[range].terrainContacts) {
+                terrainCollisions.Emit(entities[contact.a], contact.column, contact.row,
+                                       tileMap.GetTileBounds(contact.column, contact.row), contact.timeOfImpact);
+            }
+        }
+        contactCache.ForEachEnded([&](const ContactCache::Contact& contact) {
+            collisionExits.Emit(contact.a, contact.b, contact.aLabels, contact.bLabels);
+        });
+
+        spatialIndex.SetDynamicColliders(grid, bounds, colliderEntities);
+        spatialIndex.SetStaticColliders(staticGrid, staticColliders.GetBounds(), staticColliders.GetColliderEntities());
     }
 };
 
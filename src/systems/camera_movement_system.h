@@ -21,7 +21,7 @@ public:
 
     void Update(SDL_Rect& camera) {
         for (auto entity: GetEntities()) {
-            const auto& transform = entity.GetComponent<TransformComponent>();
+            const auto& transform = entity.ReadComponent<TransformComponent>();
 
             if (transform.position.x + (camera.w/2) < Game::mapWidth) {
                 camera.x = transform.position.x -(Game::windowWidth/2);
@@ -11,41 +11,47 @@
 #include "../components/projectile_component.h"
 #include "../event_bus/event_bus.h"
 #include "../events/collision_event.h"
+#include "../events/terrain_collision_event.h"
 
 class DamageSystem : public System {
+    private:
+        CollisionFilter projectileHitsPlayer;
+        CollisionFilter projectileHitsEnemy;
+        uint64_t projectileLabels;
+
     public:
-        DamageSystem() {
+        DamageSystem() : projectileHitsPlayer(EntityLabels::GetGroupMask("projectiles"), EntityLabels::GetTagMask("player")),
+                         projectileHitsEnemy(EntityLabels::GetGroupMask("projectiles"), EntityLabels::GetGroupMask("enemies")),
+                         projectileLabels(EntityLabels::GetGroupMask("projectiles")) {
             RequireComponent<BoxColliderComponent>();
         }
 
-        void SubscribeToEvents(const std::unique_ptr<EventBus>& eventBus) {
-            eventBus->SubscribeToEvent<CollisionEvent>(this, &DamageSystem::onCollision);
+        // consumes the contacts that started this frame, so a hit is only
+        // counted once however long the boxes overlap. The filters hand over
+        // (projectile, target) pairs only.
+        void Update(const std::unique_ptr<EventBus>& eventBus) {
+            const auto& collisions = eventBus->GetChannel<CollisionEnterEvent>().Read();
+            projectileHitsPlayer.ForEach(collisions, [this](const Entity projectile, const Entity player) {
+                TRACE_EVENT_HANDLER(CollisionEnterEvent, "DamageSystem");
+                onProjectileHitsPlayer(projectile, player);
+            });
+            projectileHitsEnemy.ForEach(collisions, [this](const Entity projectile, const Entity enemy) {
+                TRACE_EVENT_HANDLER(CollisionEnterEvent, "DamageSystem");
+                onProjectileHitsEnemy(projectile, enemy);
+            });
+            // solid terrain stops every projectile
+            for (const auto& collision: eventBus->GetChannel<TerrainCollisionEvent>().Read()) {
+                if (collision.labels & projectileLabels) {
+                    TRACE_EVENT_HANDLER(TerrainCollisionEvent, "DamageSystem");
+                    collision.entity.Destroy();
+                }
+            }
         }
 
     private:
-        void onCollision(CollisionEvent& event) {
-            const Entity a = event.a;
-            const Entity b = event.b;
-
-            if (a.BelongsToGroup("projectiles") && b.HasTag("player")) {
-                onProjectileHitsPlayer(a, b); // "a" is the projectile, "b" is the player
-            }
-
-            if (b.BelongsToGroup("projectiles") && a.HasTag("player")) {
-                onProjectileHitsPlayer(b, a); // "b" is the projectile, "a" is the player
-            }
-
-            if (a.BelongsToGroup("projectiles") && b.BelongsToGroup("enemies")) {
-                onProjectileHitsEnemy(a, b);
-            }
-
-            if (b.BelongsToGroup("projectiles") && a.BelongsToGroup("enemies")) {
-                onProjectileHitsEnemy(b, a);
-            }
-        }
 
         void onProjectileHitsEnemy(Entity projectile, Entity enemy) {
-            const auto projectileComponent = projectile.GetComponent<ProjectileComponent>();
+            const auto projectileComponent = projectile.ReadComponent<ProjectileComponent>();
             if (projectileComponent.isFriendly) {
                 auto& healthComponent = enemy.GetComponent<HealthComponent>();
                 healthComponent.healthPercentage -= projectileComponent.hitPercentDamage;
@@ -57,7 +63,7 @@ class DamageSystem : public System {
         }
 
         void onProjectileHitsPlayer(const Entity projectile, const Entity player) {
-            const auto projectileComponent = projectile.GetComponent<ProjectileComponent>();
+            const auto projectileComponent = projectile.ReadComponent<ProjectileComponent>();
 
             if (!projectileComponent.isFriendly) {
                 // Reduce the health of the player by the projectile hitPercentDamage
@@ -75,8 +81,6 @@ class DamageSystem : public System {
                 projectile.Destroy();
             }
         }
-
-        void Update() {}
 };
 
 #endif //DAMAGE_SYSTEM_H
@@ -0,0 +1,31 @@
+#ifndef INTERPOLATION_SYSTEM_H
+#define INTERPOLATION_SYSTEM_H
+
+#include "../ecs/ecs.h"
+#include "../components/transform_component.h"
+
+// Remembers where every transform was before the current simulation step. The
+// simulation runs at a fixed rate and the render systems draw each entity
+// between its previous and current position, by how far the frame is into
+// the next step.
+class InterpolationSystem : public System {
+public:
+    InterpolationSystem() {
+        RequireComponent<TransformComponent>();
+    }
+
+    // called before every fixed step. Every transform, scripts move entities
+    // without a rigid body too. Only the ones that moved are written, so a
+    // step where nothing moved leaves the transform pool unchanged for the
+    // snapshots and the pool ordering.
+    void SavePreviousPositions() const {
+        for (auto entity: GetEntityList()) {
+            const auto& transform = entity.ReadComponent<TransformComponent>();
+            if (transform.previousPosition != transform.position) {
+                entity.GetComponent<TransformComponent>().previousPosition = transform.position;
+            }
+        }
+    }
+};
+
+#endif //INTERPOLATION_SYSTEM_H
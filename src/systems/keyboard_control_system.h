@@ -21,13 +21,15 @@ public:
     }
 
     void SubscribeToEvents(const std::unique_ptr<EventBus>& eventBus) {
-        eventBus->SubscribeToEvent<KeyPressedEvent>(this, &KeyboardControlSystem::OnKeyPressed);
+        keyPressedSubscription = eventBus->SubscribeToEvent<&KeyboardControlSystem::OnKeyPressed>(this);
     }
 
 private:
+    EventSubscription keyPressedSubscription;
+
     void OnKeyPressed(KeyPressedEvent& e) {
         for (auto entity: GetEntities()) {
-            const auto keyboardControl = entity.GetComponent<KeywordControlledComponent>();
+            const auto keyboardControl = entity.ReadComponent<KeywordControlledComponent>();
             auto& sprite = entity.GetComponent<SpriteComponent>();
             auto& rigidBody = entity.GetComponent<RigidBodyComponent>();
 
@@ -4,64 +4,123 @@
 #include "../ecs/ecs.h"
 #include "../components/transform_component.h"
 #include "../components/rigid_body_component.h"
+#include "../components/box_collider_component.h"
+#include "../components/sprite_component.h"
 #include "../event_bus/event_bus.h"
 #include "../events/collision_event.h"
+#include "../events/terrain_collision_event.h"
+#include "../game/activity_regions.h"
 #include "../logger/logger.h"
+#include "../physics/motion_batch.h"
 
+// Moves everything with a rigid body except the player, and destroys what
+// leaves the map. The positions and velocities are gathered into a
+// MotionArrays straight from the component pools, integrated and bounds
+// checked by IntegrateMotion, and the positions written back. The entity list
+// follows the transform pool's order (Registry::IterateSystemsInPoolOrder), so
+// the lookups walk the pools mostly front to back. Entities in
+// sleeping ActivityRegions cells are left out, and move by the whole time
+// they slept when their cell runs again.
 class MovementSystem : public System {
     //: public System {
+private:
+    CollisionFilter enemyHitsObstacle;
+    uint64_t enemyLabels;
+    // per step buffers, index = body, movingEntities maps a body to its position in the entity list
+    MotionArrays motion;
+    std::vector<int> movingEntities;
+    std::vector<int> outOfBounds;
+
 public:
-    MovementSystem() {
+    MovementSystem() : enemyHitsObstacle(EntityLabels::GetGroupMask("enemies"), EntityLabels::GetGroupMask("obstacles")),
+                       enemyLabels(EntityLabels::GetGroupMask("enemies")) {
         RequireComponent<TransformComponent>();
         RequireComponent<RigidBodyComponent>();
+        // the player is moved by the PlayerMovementSystem, which keeps it inside the map
+        ExcludeTag("player");
     }
 
-    void Update(const float deltaTime) const {
-        for (auto entity: GetEntities()) {
-            auto& transformComponent = entity.GetComponent<TransformComponent>();
-            const auto& rigidBodyComponent = entity.GetComponent<RigidBodyComponent>();
+    // mapBounds: what leaves it is destroyed
+    void Update(const std::unique_ptr<Registry>& registry, const float deltaTime, const ActivityRegions& regions,
+                const MotionBounds& mapBounds) {
+        const auto& entities = GetEntityList();
+        if (entities.empty()) {
+            return;
+        }
+        // read only, the gather leaves the pools' versions alone
+        const auto& transforms = *registry->GetComponentPool<TransformComponent>();
+        const auto& rigidBodies = *registry->GetComponentPool<RigidBodyComponent>();
 
-            transformComponent.position += rigidBodyComponent.velocity * deltaTime;
-            // Prevent the main player from moving outside the map boundaries
-            if (entity.HasTag("player")) {
-                constexpr int paddingLeft = 10;
-                constexpr int paddingTop = 10;
-                constexpr int paddingRight = 50;
-                constexpr int paddingBottom = 50;
-                transformComponent.position.x = transformComponent.position.x < paddingLeft
-                                                    ? paddingLeft
-                                                    : transformComponent.position.x;
-                transformComponent.position.x = transformComponent.position.x > Game::mapWidth - paddingRight
-                                                    ? Game::mapWidth - paddingRight
-                                                    : transformComponent.position.x;
-                transformComponent.position.y = transformComponent.position.y < paddingTop
-                                                    ? paddingTop
-                                                    : transformComponent.position.y;
-                transformComponent.position.y = transformComponent.position.y > Game::mapHeight - paddingBottom
-                                                    ? Game::mapHeight - paddingBottom
-                                                    : transformComponent.position.y;
+        motion.Resize(static_cast<int>(entities.size()));
+        movingEntities.clear();
+        for (int i = 0; i < static_cast<int>(entities.size()); i++) {
+            const int entityID = entities[i].GetID();
+            const glm::vec2 position = transforms.Get(entityID).position;
+            const int elapsedSteps = regions.GetElapsedSteps(position);
+            if (elapsedSteps == 0) {
+                continue;
             }
+            // the steps slept are made up for by scaling the velocity, 1 for awake entities
+            motion.Set(static_cast<int>(movingEntities.size()), position,
+                       rigidBodies.Get(entityID).velocity * static_cast<float>(elapsedSteps));
+            movingEntities.push_back(i);
+        }
+        const int count = static_cast<int>(movingEntities.size());
+        motion.Resize(count);
 
-            const bool isEntityOutOfBounds = (
-                transformComponent.position.x < 0 ||
-                transformComponent.position.x > Game::mapWidth ||
-                transformComponent.position.y < 0 ||
-                transformComponent.position.y > Game::mapHeight
-            );
+        outOfBounds.clear();
+        IntegrateMotion(motion, deltaTime, mapBounds, outOfBounds);
 
-            if (isEntityOutOfBounds && !entity.HasTag("player")) {
-                entity.Destroy();
-            }
+        auto& movedTransforms = *registry->GetComponentPool<TransformComponent>();
+        for (int i = 0; i < count; i++) {
+            movedTransforms.Get(entities[movingEntities[i]].GetID()).position = glm::vec2(motion.x[i], motion.y[i]);
+        }
+        for (const int i: outOfBounds) {
+            entities[movingEntities[i]].Destroy();
         }
     }
 
 
-    void SubscribeToEvents(const std::unique_ptr<EventBus>& eventBus) {
-        eventBus->SubscribeToEvent<CollisionEvent>(this, &MovementSystem::onCollision);
+    // consumes the contacts started this frame, an enemy turns around once per
+    // obstacle instead of flipping back and forth while they overlap
+    void ProcessCollisions(const std::unique_ptr<EventBus>& eventBus) {
+        const auto& collisions = eventBus->GetChannel<CollisionEnterEvent>().Read();
+        enemyHitsObstacle.ForEach(collisions, [this](const Entity enemy, const Entity obstacle) {
+            TRACE_EVENT_HANDLER(CollisionEnterEvent, "MovementSystem");
+            onEnemyHitsObstacle(enemy, obstacle);
+        });
+
+        // terrain contacts come every frame, turning only while heading into
+        // the tile keeps the enemy from flipping back and forth
+        for (const auto& collision: eventBus->GetChannel<TerrainCollisionEvent>().Read()) {
+            if (collision.labels & enemyLabels) {
+                TRACE_EVENT_HANDLER(TerrainCollisionEvent, "MovementSystem");
+                onEnemyHitsTerrain(collision.entity, collision.tileBounds);
+            }
+        }
     }
 
 private:
+    void onEnemyHitsTerrain(const Entity enemy, const AABB& tile) {
+        const auto& rigidBodyComponent = enemy.ReadComponent<RigidBodyComponent>();
+        const auto box = AABB::FromCollider(
+            enemy.ReadComponent<TransformComponent>(),
+            enemy.ReadComponent<BoxColliderComponent>()
+        );
+        // twice the distance between the centers, only its sign matters
+        const double towardsX = (tile.minX + tile.maxX - box.minX - box.maxX) * rigidBodyComponent.velocity.x;
+        const double towardsY = (tile.minY + tile.maxY - box.minY - box.maxY) * rigidBodyComponent.velocity.y;
+        // same axis TurnAround flips on
+        if (rigidBodyComponent.velocity.x != 0 ? towardsX > 0 : towardsY > 0) {
+            TurnAround(enemy);
+        }
+    }
+
     void onEnemyHitsObstacle(const Entity enemy, const Entity obstacle) {
+        TurnAround(enemy);
+    }
+
+    void TurnAround(const Entity enemy) {
         if (enemy.HasComponent<RigidBodyComponent>() && enemy.HasComponent<SpriteComponent>()) {
             auto& rigidBodyComponent = enemy.GetComponent<RigidBodyComponent>();
             auto& spriteComponent = enemy.GetComponent<SpriteComponent>();
@@ -79,17 +138,6 @@ private:
             }
         }
     }
-
-    void onCollision(CollisionEvent& collisionEvent) {
-        Entity a = collisionEvent.a;
-        Entity b = collisionEvent.b;
-
-        if (a.BelongsToGroup("enemies") && b.BelongsToGroup("obstacles")) {
-            onEnemyHitsObstacle(a, b);
-        } else if (b.BelongsToGroup("enemies") && a.BelongsToGroup("obstacles")) {
-            onEnemyHitsObstacle(b, a);
-        }
-    }
 };
 
 #endif // MOVEMENT_SYSTEM_H
@@ -0,0 +1,45 @@
+#ifndef PLAYER_MOVEMENT_SYSTEM_H
+#define PLAYER_MOVEMENT_SYSTEM_H
+
+#include "../ecs/ecs.h"
+#include "../game/game.h"
+#include "../components/transform_component.h"
+#include "../components/rigid_body_component.h"
+
+class PlayerMovementSystem : public System {
+public:
+    PlayerMovementSystem() {
+        RequireComponent<TransformComponent>();
+        RequireComponent<RigidBodyComponent>();
+        RequireTag("player");
+    }
+
+    void Update(const float deltaTime) const {
+        for (auto entity: GetEntities()) {
+            auto& transformComponent = entity.GetComponent<TransformComponent>();
+            const auto& rigidBodyComponent = entity.ReadComponent<RigidBodyComponent>();
+
+            transformComponent.position += rigidBodyComponent.velocity * deltaTime;
+
+            // Prevent the main player from moving outside the map boundaries
+            constexpr int paddingLeft = 10;
+            constexpr int paddingTop = 10;
+            constexpr int paddingRight = 50;
+            constexpr int paddingBottom = 50;
+            transformComponent.position.x = transformComponent.position.x < paddingLeft
+                                                ? paddingLeft
+                                                : transformComponent.position.x;
+            transformComponent.position.x = transformComponent.position.x > Game::mapWidth - paddingRight
+                                                ? Game::mapWidth - paddingRight
+                                                : transformComponent.position.x;
+            transformComponent.position.y = transformComponent.position.y < paddingTop
+                                                ? paddingTop
+                                                : transformComponent.position.y;
+            transformComponent.position.y = transformComponent.position.y > Game::mapHeight - paddingBottom
+                                                ? Game::mapHeight - paddingBottom
+                                                : transformComponent.position.y;
+        }
+    }
+};
+
+#endif // PLAYER_MOVEMENT_SYSTEM_H
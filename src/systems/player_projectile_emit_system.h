@@ -0,0 +1,77 @@
+#ifndef PLAYER_PROJECTILE_EMIT_SYSTEM_H
+#define PLAYER_PROJECTILE_EMIT_SYSTEM_H
+
+#include <SDL2/SDL.h>
+
+#include "../components/projectile_component.h"
+#include "../components/projectile_emitter_component.h"
+#include "../components/transform_component.h"
+#include "../components/rigid_body_component.h"
+#include "../components/sprite_component.h"
+#include "../components/box_collider_component.h"
+#include "../components/fast_mover_component.h"
+
+#include "../ecs/ecs.h"
+#include "../event_bus/event_bus.h"
+#include "../events/key_pressed_event.h"
+
+class PlayerProjectileEmitSystem : public System {
+private:
+    EventSubscription keyPressedSubscription;
+
+    void onSpacePressed(KeyPressedEvent& event) {
+        if (event.key == SDLK_SPACE) {
+            for (auto entity: GetEntities()) {
+                const auto projectileEmitter = entity.ReadComponent<ProjectileEmitterComponent>();
+                const auto transform = entity.ReadComponent<TransformComponent>();
+                const auto rigidbody = entity.ReadComponent<RigidBodyComponent>();
+
+                // If parent entity has sprite, start the projectile position in the middle of the entity
+                glm::vec2 projectilePosition = transform.position;
+                if (entity.HasComponent<SpriteComponent>()) {
+                    const auto sprite = entity.ReadComponent<SpriteComponent>();
+                    projectilePosition.x += (transform.scale.x * sprite.width / 2);
+                    projectilePosition.y += (transform.scale.y * sprite.height / 2);
+                }
+
+                // If parent entity direction is controlled by the keyboard keys, modify the direction of the projectile accordingly
+                glm::vec2 projectileVelocity = projectileEmitter.velocity;
+                int directionX = 0;
+                int directionY = 0;
+                if (rigidbody.velocity.x > 0) directionX = +1;
+                if (rigidbody.velocity.x < 0) directionX = -1;
+                if (rigidbody.velocity.y > 0) directionY = +1;
+                if (rigidbody.velocity.y < 0) directionY = -1;
+                projectileVelocity.x = projectileEmitter.velocity.x * directionX;
+                projectileVelocity.y = projectileEmitter.velocity.y * directionY;
+
+                // Create new projectile entity and add it to the world
+                Entity projectile = entity.registry->CreateEntity();
+                projectile.Group("projectiles");
+                projectile.AddComponent<TransformComponent>(projectilePosition, glm::vec2(1.0, 1.0), 0.0);
+                projectile.AddComponent<RigidBodyComponent>(projectileVelocity);
+                projectile.AddComponent<SpriteComponent>("bullet-texture", 4, 4, 4);
+                projectile.AddComponent<BoxColliderComponent>(4, 4, glm::vec2(0), COLLISION_LAYER_PROJECTILES);
+                projectile.AddComponent<FastMoverComponent>(projectilePosition);
+                projectile.AddComponent<ProjectileComponent>(
+                    projectileEmitter.isFriendly, projectileEmitter.hitPercentDamage,
+                    projectileEmitter.duration
+                );
+            }
+        }
+    }
+
+public:
+    PlayerProjectileEmitSystem() {
+        RequireComponent<ProjectileEmitterComponent>();
+        RequireComponent<TransformComponent>();
+        RequireComponent<RigidBodyComponent>();
+        RequireTag("player");
+    }
+
+    void SubscribeToEvents(const std::unique_ptr<EventBus>& eventBus) {
+        keyPressedSubscription = eventBus->SubscribeToEvent<&PlayerProjectileEmitSystem::onSpacePressed>(this);
+    }
+};
+
+#endif //PLAYER_PROJECTILE_EMIT_SYSTEM_H
@@ -13,80 +13,38 @@
 #include "../components/rigid_body_component.h"
 #include "../components/sprite_component.h"
 #include "../components/box_collider_component.h"
+#include "../components/fast_mover_component.h"
 #include "../components/camera_component.h"
 
 #include "../logger/logger.h"
 #include "../ecs/ecs.h"
+#include "../game/activity_regions.h"
+#include "../timing/frame_clock.h"
 
 class ProjectileEmitSystem : public System {
-private:
-    void onSpacePressed(KeyPressedEvent& event) {
-        if (event.key == SDLK_SPACE) {
-            for (auto entity: GetEntities()) {
-                if (entity.HasTag("player")) {
-                    const auto projectileEmitter = entity.GetComponent<ProjectileEmitterComponent>();
-                    const auto transform = entity.GetComponent<TransformComponent>();
-                    const auto rigidbody = entity.GetComponent<RigidBodyComponent>();
-
-                    // If parent entity has sprite, start the projectile position in the middle of the entity
-                    glm::vec2 projectilePosition = transform.position;
-                    if (entity.HasComponent<SpriteComponent>()) {
-                        const auto sprite = entity.GetComponent<SpriteComponent>();
-                        projectilePosition.x += (transform.scale.x * sprite.width / 2);
-                        projectilePosition.y += (transform.scale.y * sprite.height / 2);
-                    }
-
-                    // If parent entity direction is controlled by the keyboard keys, modify the direction of the projectile accordingly
-                    glm::vec2 projectileVelocity = projectileEmitter.velocity;
-                    int directionX = 0;
-                    int directionY = 0;
-                    if (rigidbody.velocity.x > 0) directionX = +1;
-                    if (rigidbody.velocity.x < 0) directionX = -1;
-                    if (rigidbody.velocity.y > 0) directionY = +1;
-                    if (rigidbody.velocity.y < 0) directionY = -1;
-                    projectileVelocity.x = projectileEmitter.velocity.x * directionX;
-                    projectileVelocity.y = projectileEmitter.velocity.y * directionY;
-
-                    // Create new projectile entity and add it to the world
-                    Entity projectile = entity.registry->CreateEntity();
-                    projectile.Group("projectiles");
-                    projectile.AddComponent<TransformComponent>(projectilePosition, glm::vec2(1.0, 1.0), 0.0);
-                    projectile.AddComponent<RigidBodyComponent>(projectileVelocity);
-                    projectile.AddComponent<SpriteComponent>("bullet-texture", 4, 4, 4);
-                    projectile.AddComponent<BoxColliderComponent>(4, 4);
-                    projectile.AddComponent<ProjectileComponent>(
-                        projectileEmitter.isFriendly, projectileEmitter.hitPercentDamage,
-                        projectileEmitter.duration
-                    );
-                }
-            }
-        }
-    }
-
 public:
     ProjectileEmitSystem() {
         RequireComponent<ProjectileEmitterComponent>();
         RequireComponent<TransformComponent>();
     }
 
-    void SubscribeToEvents(const std::unique_ptr<EventBus>& eventBus) {
-        eventBus->SubscribeToEvent<KeyPressedEvent>(this, &ProjectileEmitSystem::onSpacePressed);
-    }
-
-    void Update(const std::unique_ptr<Registry>& registry) {
+    // emitters in sleeping cells only fire when their cell runs. The emission
+    // time is absolute, a woken emitter fires once if it is due, no burst.
+    void Update(const std::unique_ptr<Registry>& registry, const ActivityRegions& regions) {
+        const int now = FrameClock::GetMilliseconds();
         for (auto entities: GetEntities()) {
-            auto& projectileEmitterComponent = entities.GetComponent<ProjectileEmitterComponent>();
-            const auto transformComponent = entities.GetComponent<TransformComponent>();
+            const auto& projectileEmitterComponent = entities.ReadComponent<ProjectileEmitterComponent>();
+            const auto transformComponent = entities.ReadComponent<TransformComponent>();
 
-            if (projectileEmitterComponent.frequency == 0) {
+            if (projectileEmitterComponent.frequency == 0 || !regions.IsActive(transformComponent.position)) {
                 continue;
             }
 
-            if (static_cast<int>(SDL_GetTicks()) - projectileEmitterComponent.lastEmissionTime >
+            if (now - projectileEmitterComponent.lastEmissionTime >
                 projectileEmitterComponent.frequency) {
                 glm::vec2 projectilePosition = transformComponent.position;
                 if (entities.HasComponent<SpriteComponent>()) {
-                    const auto spriteComponent = entities.GetComponent<SpriteComponent>();
+                    const auto spriteComponent = entities.ReadComponent<SpriteComponent>();
                     projectilePosition.x += (transformComponent.scale.x * spriteComponent.width / 2);
                     projectilePosition.y += (transformComponent.scale.y * spriteComponent.height / 2);
                 }
@@ -101,13 +59,14 @@ public:
 
                 projectile.AddComponent<RigidBodyComponent>(projectileEmitterComponent.velocity);
                 projectile.AddComponent<SpriteComponent>("bullet-texture", 4, 4, 4);
-                projectile.AddComponent<BoxColliderComponent>(4, 4);
+                projectile.AddComponent<BoxColliderComponent>(4, 4, glm::vec2(0), COLLISION_LAYER_PROJECTILES);
+                projectile.AddComponent<FastMoverComponent>(projectilePosition);
                 projectile.AddComponent<ProjectileComponent>(
                     projectileEmitterComponent.isFriendly,
                     projectileEmitterComponent.hitPercentDamage,
                     projectileEmitterComponent.duration
                 );
-                projectileEmitterComponent.lastEmissionTime = static_cast<int>(SDL_GetTicks());
+                entities.GetComponent<ProjectileEmitterComponent>().lastEmissionTime = now;
             }
         }
     }
@@ -6,6 +6,7 @@
 #define PROJECTILE_LIFECYCLE_SYSTEM_H
 #include "../components/projectile_component.h"
 #include "../ecs/ecs.h"
+#include "../timing/frame_clock.h"
 
 class ProjectileLifecycleSystem : public System {
 public:
@@ -14,9 +15,10 @@ public:
     }
 
     void Update() {
+        const int now = FrameClock::GetMilliseconds();
         for (auto entity: GetEntities()) {
-            const auto projectileComponent = entity.GetComponent<ProjectileComponent>();
-            if (static_cast<int>(SDL_GetTicks()) - projectileComponent.startTime > projectileComponent.duration) {
+            const auto projectileComponent = entity.ReadComponent<ProjectileComponent>();
+            if (now - projectileComponent.startTime > projectileComponent.duration) {
                 entity.Destroy();
             }
         }
@@ -18,14 +18,15 @@ public:
         RequireComponent<TransformComponent>();
     }
 
-    void Update(SDL_Renderer* renderer, SDL_Rect camera) {
+    void Update(SDL_Renderer* renderer, SDL_Rect camera, const float alpha = 1.0f) {
         for (auto entity: GetEntities()) {
-            const auto transformComponent = entity.GetComponent<TransformComponent>();
-            const auto colliderComponent = entity.GetComponent<BoxColliderComponent>();
+            const auto transformComponent = entity.ReadComponent<TransformComponent>();
+            const auto colliderComponent = entity.ReadComponent<BoxColliderComponent>();
+            const auto position = transformComponent.GetInterpolatedPosition(alpha);
 
             SDL_Rect colliderRect = {
-                static_cast<int>(transformComponent.position.x + colliderComponent.offset.x - camera.x),
-                static_cast<int>(transformComponent.position.y + colliderComponent.offset.y - camera.y),
+                static_cast<int>(position.x + colliderComponent.offset.x - camera.x),
+                static_cast<int>(position.y + colliderComponent.offset.y - camera.y),
                 static_cast<int>(colliderComponent.width * transformComponent.scale.x),
                 static_cast<int>(colliderComponent.height * transformComponent.scale.y)
             };
@@ -22,11 +22,12 @@ public:
         RequireComponent<SpriteComponent>();
     }
 
-    void Update(SDL_Renderer* renderer, const std::unique_ptr<AssetStore>& assetStore, const SDL_Rect& camera) {
+    void Update(SDL_Renderer* renderer, const std::unique_ptr<AssetStore>& assetStore, const SDL_Rect& camera,
+                const float alpha = 1.0f) {
         for (auto entity: GetEntities()) {
-            const auto health = entity.GetComponent<HealthComponent>();
-            const auto transform = entity.GetComponent<TransformComponent>();
-            const auto sprite = entity.GetComponent<SpriteComponent>();
+            const auto health = entity.ReadComponent<HealthComponent>();
+            const auto transform = entity.ReadComponent<TransformComponent>();
+            const auto sprite = entity.ReadComponent<SpriteComponent>();
 
             SDL_Color healthBarColor = {255, 255, 255};
             if (health.healthPercentage >= 0 && health.healthPercentage < 40) {
@@ -42,8 +43,9 @@ public:
 
             constexpr int healthBarWidth = 15;
             constexpr int healthBarHeight = 3;
-            const auto healthBarPosX = transform.position.x + sprite.width * transform.scale.x - camera.x;
-            const auto healthBarPosY = transform.position.y - camera.y;
+            const auto position = transform.GetInterpolatedPosition(alpha);
+            const auto healthBarPosX = position.x + sprite.width * transform.scale.x - camera.x;
+            const auto healthBarPosY = position.y - camera.y;
             SDL_Rect healthBarPosition = {
                 static_cast<int>(healthBarPosX),
                 static_cast<int>(healthBarPosY),
@@ -22,7 +22,9 @@ public:
         RequireComponent<SpriteComponent>();
     }
 
-    void Update(SDL_Renderer* renderer, std::unique_ptr<AssetStore>& assetStore, SDL_Rect& camera) const {
+    // alpha = how far the frame is between the last two simulation steps
+    void Update(SDL_Renderer* renderer, std::unique_ptr<AssetStore>& assetStore, SDL_Rect& camera,
+                const float alpha = 1.0f) const {
         // sort all the entities of our system by their zIndex
         struct RenderableEntity {
             TransformComponent transformComponent;
@@ -31,9 +33,11 @@ public:
         std::vector<RenderableEntity> renderableEntities;
         for (auto entity: GetEntities()) {
             RenderableEntity renderableEntity = {
-                .transformComponent = entity.GetComponent<TransformComponent>(),
-                .spriteComponent = entity.GetComponent<SpriteComponent>()
+                .transformComponent = entity.ReadComponent<TransformComponent>(),
+                .spriteComponent = entity.ReadComponent<SpriteComponent>()
             };
+            renderableEntity.transformComponent.position =
+                renderableEntity.transformComponent.GetInterpolatedPosition(alpha);
 
             // Check if the entity sprite is outside the camera view
             bool isOutsideCameraView = (
@@ -15,7 +15,7 @@ public:
 
     void Update(SDL_Renderer* renderer, std::unique_ptr<AssetStore>& assetStore, const SDL_Rect& camera) {
         for(auto entity: GetEntities()) {
-            const auto textLabel = entity.GetComponent<TextLabelComponent>();
+            const auto textLabel = entity.ReadComponent<TextLabelComponent>();
 
             SDL_Surface* surface = TTF_RenderText_Blended(
                 assetStore->GetFont(textLabel.assetID),
@@ -5,12 +5,16 @@
 #ifndef SCRIPT_SYSTEM_H
 #define SCRIPT_SYSTEM_H
 
+#include "../collision/spatial_index.h"
 #include "../components/script_component.h"
+#include "../components/transform_component.h"
 #include "../ecs/ecs.h"
+#include "../game/activity_regions.h"
+#include "box_collider_system.h"
 
 std::tuple<double, double> GetEntityPosition(Entity entity) {
     if (entity.HasComponent<TransformComponent>()) {
-        const auto transform = entity.GetComponent<TransformComponent>();
+        const auto transform = entity.ReadComponent<TransformComponent>();
         return std::make_tuple(transform.position.x, transform.position.y);
     } else {
         Logger::Err("Trying to get the position of an entity that has no transform component");
@@ -20,7 +24,7 @@ std::tuple<double, double> GetEntityPosition(Entity entity) {
 
 std::tuple<double, double> GetEntityVelocity(Entity entity) {
     if (entity.HasComponent<RigidBodyComponent>()) {
-        const auto rigidbody = entity.GetComponent<RigidBodyComponent>();
+        const auto rigidbody = entity.ReadComponent<RigidBodyComponent>();
         return std::make_tuple(rigidbody.velocity.x, rigidbody.velocity.y);
     } else {
         Logger::Err("Trying to get the velocity of an entity that has no rigidbody component");
@@ -85,12 +89,15 @@ class ScriptSystem : public System {
         }
 
 
-        void CreateLuaBindings(sol::state& lua) {
+        void CreateLuaBindings(sol::state& lua, const std::unique_ptr<Registry>& registry) {
             // Create the "entity" usertype so Lua knows what an entity is
             lua.new_usertype<Entity>(
                 "entity",
                 "get_id", &Entity::GetID,
                 "destroy", &Entity::Destroy,
+                "enable", &Entity::Enable,
+                "disable", &Entity::Disable,
+                "is_enabled", &Entity::IsEnabled,
                 "has_tag", &Entity::HasTag,
                 "belongs_to_group", &Entity::BelongsToGroup
             );
@@ -103,13 +110,67 @@ class ScriptSystem : public System {
             lua.set_function("set_rotation", SetEntityRotation);
             lua.set_function("set_projectile_velocity", SetProjectileVelocity);
             lua.set_function("set_animation_frame", SetEntityAnimationFrame);
+
+            // Spatial queries, lists of entities come back as arrays. The
+            // layer mask is optional and defaults to every layer.
+            Registry* queries = registry.get();
+            lua.set_function("query_aabb", [queries](double x, double y, double width, double height,
+                                                     sol::optional<uint32_t> layerMask) {
+                return sol::as_table(queries->QueryAABB(x, y, x + width, y + height,
+                                                        layerMask.value_or(ALL_COLLISION_LAYERS)));
+            });
+            lua.set_function("query_radius", [queries](double x, double y, double radius,
+                                                       sol::optional<uint32_t> layerMask) {
+                return sol::as_table(queries->QueryRadius(x, y, radius, layerMask.value_or(ALL_COLLISION_LAYERS)));
+            });
+            lua.set_function("nearest", [queries](double x, double y, int k, sol::optional<uint32_t> layerMask) {
+                return sol::as_table(queries->Nearest(x, y, k, layerMask.value_or(ALL_COLLISION_LAYERS)));
+            });
+            // local entity, distance, hit_x, hit_y = raycast(...), entity is nil on a miss
+            lua.set_function("raycast", [queries](double x, double y, double directionX, double directionY,
+                                                  double maxDistance, sol::optional<uint32_t> layerMask) {
+                RaycastHit hit;
+                if (!queries->Raycast(x, y, directionX, directionY, maxDistance, hit,
+                                      layerMask.value_or(ALL_COLLISION_LAYERS))) {
+                    return std::make_tuple(sol::optional<Entity>(), 0.0, 0.0, 0.0);
+                }
+                return std::make_tuple(sol::optional<Entity>(hit.entity), hit.distance, hit.x, hit.y);
+            });
+
+            // Terrain, the solid tiles of the tilemap
+            const TileCollisionMap* terrain = &registry->GetSystem<BoxColliderSystem>().GetTileMap();
+            lua.set_function("is_solid_at", [terrain](double x, double y) {
+                return terrain->IsSolidAt(x, y);
+            });
+            // local distance, column, row = raycast_terrain(...), distance is nil on a miss
+            lua.set_function("raycast_terrain", [terrain](double x, double y, double directionX, double directionY,
+                                                          double maxDistance) {
+                const double length = std::sqrt(directionX * directionX + directionY * directionY);
+                double distance;
+                int column, row;
+                if (length == 0 || !terrain->Raycast(x, y, directionX / length, directionY / length, maxDistance,
+                                                     distance, column, row)) {
+                    return std::make_tuple(sol::optional<double>(), 0, 0);
+                }
+                return std::make_tuple(sol::optional<double>(distance), column, row);
+            });
         }
 
-        void Update(double deltaTime, int ellapsedTime) {
+        // scripts of entities in sleeping cells run when their cell does, with
+        // the delta time of every step they slept
+        void Update(double deltaTime, int ellapsedTime, const ActivityRegions& regions) {
             // Loop all entities that have a script component and invoke their Lua function
             for (auto entity: GetEntities()) {
-                const auto script = entity.GetComponent<ScriptComponent>();
-                script.func(entity, deltaTime, ellapsedTime); // here is where we invoke a sol::function
+                int elapsedSteps = 1;
+                if (entity.HasComponent<TransformComponent>()) {
+                    elapsedSteps = regions.GetElapsedSteps(entity.ReadComponent<TransformComponent>().position);
+                    if (elapsedSteps == 0) {
+                        continue;
+                    }
+                }
+                const auto& script = entity.ReadComponent<ScriptComponent>();
+                // here is where we invoke a sol::function
+                script.func(entity, deltaTime * elapsedSteps, ellapsedTime);
             }
         }
 };
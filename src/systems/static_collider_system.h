@@ -0,0 +1,107 @@
+#ifndef STATIC_COLLIDER_SYSTEM_H
+#define STATIC_COLLIDER_SYSTEM_H
+
+#include <vector>
+
+#include "../collision/uniform_grid.h"
+#include "../collision/pixel_mask.h"
+#include "../components/box_collider_component.h"
+#include "../components/collision_mask_component.h"
+#include "../components/sprite_component.h"
+#include "../components/rigid_body_component.h"
+#include "../components/transform_component.h"
+#include "../ecs/ecs.h"
+
+// Colliders without a RigidBodyComponent (obstacles, trees, buildings, parked
+// vehicles) never move, so they live in their own grid. It is built once
+// after the level loads and rebuilt only when a static collider is added or
+// removed, instead of every frame. Anything a script moves around needs a
+// RigidBodyComponent to be treated as dynamic. Pixel masks are taken from the
+// sprite frame shown when the grid is built, static sprites do not animate.
+class StaticColliderSystem : public System {
+private:
+    UniformGrid grid;
+    // index = box index in the grid
+    std::vector<Entity> staticEntities;
+    std::vector<AABB> bounds;
+    std::vector<LayerFilter> filters;
+    std::vector<PlacedMask> masks;
+    bool hasMasks = false;
+    bool isBuilt = false;
+    unsigned int builtVersion = 0;
+
+public:
+    StaticColliderSystem() {
+        RequireComponent<BoxColliderComponent>();
+        RequireComponent<TransformComponent>();
+        ExcludeComponent<RigidBodyComponent>();
+    }
+
+    void Update() {
+        if (isBuilt && builtVersion == GetEntitiesVersion()) {
+            return;
+        }
+        staticEntities = GetEntities();
+        bounds.clear();
+        filters.clear();
+        masks.clear();
+        hasMasks = false;
+        for (auto entity: staticEntities) {
+            const auto& collider = entity.ReadComponent<BoxColliderComponent>();
+            const auto& transform = entity.ReadComponent<TransformComponent>();
+            bounds.push_back(AABB::FromCollider(transform, collider));
+            masks.push_back(GetPlacedMask(entity, transform));
+            hasMasks = hasMasks || masks.back().mask;
+            // the layer matrix is applied by the dynamic side of each pair
+            filters.push_back(CollisionLayerMatrix::GetUnfilteredFilter(collider));
+        }
+        grid.Build(bounds, filters);
+        builtVersion = GetEntitiesVersion();
+        isBuilt = true;
+    }
+
+    // where the sprite's current frame mask is drawn, no mask when the entity has no CollisionMaskComponent
+    static PlacedMask GetPlacedMask(const Entity entity, const TransformComponent& transform) {
+        PlacedMask placedMask;
+        if (entity.HasComponent<CollisionMaskComponent>() && entity.HasComponent<SpriteComponent>()) {
+            const auto* spriteMasks = entity.ReadComponent<CollisionMaskComponent>().masks;
+            const auto& sprite = entity.ReadComponent<SpriteComponent>();
+            if (spriteMasks) {
+                placedMask.mask = spriteMasks->Get(sprite.srcRect.x, sprite.srcRect.y, sprite.flip);
+                placedMask.x = transform.position.x;
+                placedMask.y = transform.position.y;
+                placedMask.scaleX = transform.scale.x;
+                placedMask.scaleY = transform.scale.y;
+            }
+        }
+        return placedMask;
+    }
+
+    const UniformGrid& GetGrid() const {
+        return grid;
+    }
+
+    Entity GetEntity(const int index) const {
+        return staticEntities[index];
+    }
+
+    // index = box index in the grid
+    const std::vector<Entity>& GetColliderEntities() const {
+        return staticEntities;
+    }
+
+    const std::vector<AABB>& GetBounds() const {
+        return bounds;
+    }
+
+    // index = box index in the grid
+    const std::vector<PlacedMask>& GetMasks() const {
+        return masks;
+    }
+
+    bool HasMasks() const {
+        return hasMasks;
+    }
+};
+
+#endif //STATIC_COLLIDER_SYSTEM_H
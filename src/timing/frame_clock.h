@@ -0,0 +1,36 @@
+#ifndef FRAME_CLOCK_H
+#define FRAME_CLOCK_H
+
+#include <cstdint>
+
+// The game time, advanced once per simulation step. Systems and components
+// read it instead of SDL_GetTicks, so everything in a step sees the same time
+// and timers (animations, emitters, projectile lifetimes) replay the same way
+// at any frame rate and do not run on while the game stalls.
+class FrameClock {
+private:
+    inline static uint64_t steps = 0;
+    inline static int stepsPerSecond = 60;
+
+public:
+    static void Reset(const int stepsPerSecond) {
+        FrameClock::steps = 0;
+        FrameClock::stepsPerSecond = stepsPerSecond;
+    }
+
+    // called at the start of every simulation step
+    static void Step() {
+        steps++;
+    }
+
+    static uint64_t GetSteps() {
+        return steps;
+    }
+
+    // same unit as SDL_GetTicks, which this replaces
+    static int GetMilliseconds() {
+        return static_cast<int>(steps * 1000 / stepsPerSecond);
+    }
+};
+
+#endif //FRAME_CLOCK_H
@@ -0,0 +1,99 @@
+#include "frame_pacer.h"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <cmath>
+
+// SDL_Delay may wake this much late, the rest of the wait is spun
+constexpr double DEFAULT_SPIN_MILLISECONDS = 2.0;
+
+FramePacer::FramePacer() : frequency(SDL_GetPerformanceFrequency()),
+                           spinCounts(static_cast<uint64_t>(DEFAULT_SPIN_MILLISECONDS * frequency / 1000)) {
+}
+
+void FramePacer::SetTargetFps(const int fps) {
+    targetFps = std::max(0, fps);
+    UpdateInterval();
+}
+
+void FramePacer::SetVsync(const bool isEnabled, const int refreshRate) {
+    isVsyncEnabled = isEnabled;
+    this->refreshRate = std::max(0, refreshRate);
+    UpdateInterval();
+}
+
+void FramePacer::SetSpinMilliseconds(const double milliseconds) {
+    spinCounts = static_cast<uint64_t>(std::max(0.0, milliseconds) * frequency / 1000);
+}
+
+void FramePacer::UpdateInterval() {
+    interval = targetFps > 0 ? frequency / targetFps : 0;
+    presentMargin = 0;
+    if (!isVsyncEnabled) {
+        return;
+    }
+    // the present paces the frames at an unknown rate, waiting as well would
+    // drop every other refresh
+    if (refreshRate <= 0) {
+        interval = 0;
+        return;
+    }
+    // the present blocks until the next refresh, so only whole numbers of
+    // refreshes per frame are shown evenly, take the one closest to the target
+    const uint64_t refresh = frequency / refreshRate;
+    const int refreshesPerFrame = targetFps > 0
+        ? std::max(1, static_cast<int>(std::lround(static_cast<double>(refreshRate) / targetFps)))
+        : 1;
+    interval = refreshesPerFrame > 1 ? refresh * refreshesPerFrame : 0;
+    presentMargin = refresh / 2;
+}
+
+double FramePacer::GetEffectiveFps() const {
+    if (interval == 0) {
+        return isVsyncEnabled ? refreshRate : 0;
+    }
+    return static_cast<double>(frequency) / interval;
+}
+
+double FramePacer::WaitForNextFrame() {
+    uint64_t now = SDL_GetPerformanceCounter();
+    if (previousFrame == 0) {
+        previousFrame = now;
+        deadline = now;
+    }
+
+    if (interval > 0) {
+        deadline += interval;
+        const uint64_t wakeUp = deadline - presentMargin;
+        if (now > wakeUp + interval) {
+            // more than a frame behind, start over instead of rushing to catch up
+            deadline = now + presentMargin;
+        } else {
+            if (wakeUp > now + spinCounts) {
+                SDL_Delay(static_cast<Uint32>((wakeUp - now - spinCounts) * 1000 / frequency));
+            }
+            do {
+                now = SDL_GetPerformanceCounter();
+            } while (now < wakeUp);
+        }
+    }
+
+    const double elapsed = static_cast<double>(now - previousFrame) / frequency;
+    previousFrame = now;
+    if (const double fps = GetEffectiveFps(); fps > 0) {
+        lastError = elapsed - 1.0 / fps;
+        maxError = std::max(maxError, lastError);
+        errorSum += std::abs(lastError);
+        errorCount++;
+    }
+    return elapsed;
+}
+
+void FramePacer::TakeErrorStats(double& maxError, double& meanError) {
+    maxError = this->maxError;
+    meanError = errorCount > 0 ? errorSum / errorCount : 0;
+    this->maxError = 0;
+    errorSum = 0;
+    errorCount = 0;
+}
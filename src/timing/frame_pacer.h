@@ -0,0 +1,61 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <cstdint>
+
+// Paces the main loop on SDL_GetPerformanceCounter. Frames are due at fixed
+// deadlines one interval apart: the pacer sleeps until shortly before the
+// deadline and spins the rest, SDL_Delay alone oversleeps by up to a
+// millisecond or more. With vsync on, SDL_RenderPresent already waits for the
+// display, so the pacer only waits when the target is a fraction of the
+// refresh rate and leaves the last half refresh to the present. The pacing
+// error of every frame (its length minus the paced interval) is recorded.
+class FramePacer {
+private:
+    uint64_t frequency;
+    // counts between two deadlines, 0 = not capped
+    uint64_t interval = 0;
+    // the end of the wait is spun, not slept
+    uint64_t spinCounts;
+    // how much earlier than the deadline to hand over to the present, vsync only
+    uint64_t presentMargin = 0;
+    uint64_t previousFrame = 0;
+    uint64_t deadline = 0;
+
+    int targetFps = 0;
+    int refreshRate = 0;
+    bool isVsyncEnabled = false;
+
+    // seconds the last frame took longer than the paced interval, negative when shorter
+    double lastError = 0;
+    double maxError = 0;
+    double errorSum = 0;
+    int errorCount = 0;
+
+    void UpdateInterval();
+
+public:
+    FramePacer();
+
+    // 0 removes the cap
+    void SetTargetFps(int fps);
+    // refreshRate in Hz, 0 when unknown. With vsync on and an unknown rate the
+    // present alone paces the frames and the target is ignored.
+    void SetVsync(bool isEnabled, int refreshRate);
+    void SetSpinMilliseconds(double milliseconds);
+
+    // the frame rate actually paced to, vsync rounds the target to a fraction of the refresh rate
+    double GetEffectiveFps() const;
+
+    // waits for the next frame and returns the seconds since the previous one
+    double WaitForNextFrame();
+
+    double GetLastError() const {
+        return lastError;
+    }
+
+    // the worst lateness and the mean absolute error since the last call
+    void TakeErrorStats(double& maxError, double& meanError);
+};
+
+#endif //FRAME_PACER_H